@@ -37,7 +37,6 @@ microdnf -y install \
   git \
   java-1.8.0-devel \
   llvm \
-  mxml-devel \
   pinentry \
   rpm-build \
   rpm-sign \
@@ -182,6 +182,41 @@ object DFDL {
      * @return path of newly built executable (exe) compiled from generated code
      */
     def compileCode(codeDir: os.Path): os.Path
+
+    /**
+     * Compiles the generated code with the given build profile instead of the
+     * runtime2BuildProfile tunable's profile
+     * @param codeDir path of newly created directory containing generated code
+     * @param profile how to compile the generated code (debug, release, or native)
+     * @return path of newly built executable (exe) compiled from generated code
+     */
+    def compileCode(codeDir: os.Path, profile: Runtime2BuildProfile): os.Path
+
+    /**
+     * Compiles the generated code with the given build profile and profile-guided optimization,
+     * running an instrumented build over the training inputs before building the final executable
+     * @param codeDir path of newly created directory containing generated code
+     * @param profile how to compile the generated code (debug, release, or native)
+     * @param trainingInputs data files representative of the data the executable will parse
+     * @return path of newly built executable (exe) compiled from generated code
+     */
+    def compileTrainedCode(codeDir: os.Path, profile: Runtime2BuildProfile, trainingInputs: Seq[os.Path]): os.Path
+
+    /**
+     * Compiles the generated code into a shared library in order to parse or unparse in-process
+     * @param codeDir path of newly created directory containing generated code
+     * @return path of newly built shared library (lib) compiled from generated code
+     */
+    def compileLibrary(codeDir: os.Path): os.Path
+
+    /**
+     * Compiles the generated code into a shared library with the given build profile
+     * instead of the runtime2BuildProfile tunable's profile
+     * @param codeDir path of newly created directory containing generated code
+     * @param profile how to compile the generated code (debug, release, or native)
+     * @return path of newly built shared library (lib) compiled from generated code
+     */
+    def compileLibrary(codeDir: os.Path, profile: Runtime2BuildProfile): os.Path
   }
 
   trait DataProcessorBase {
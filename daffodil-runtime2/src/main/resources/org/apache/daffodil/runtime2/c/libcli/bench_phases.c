@@ -0,0 +1,709 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "bench_phases.h"
+#include <errno.h>         // for errno
+#include <inttypes.h>      // for strtoimax, strtoumax
+#include <math.h>          // for isnan
+#include <stdbool.h>       // for bool, false, true
+#include <stdint.h>        // for int64_t, uint64_t, int16_t, int32_t, int8_t, uint16_t, uint32_t, uint8_t
+#include <stdio.h>         // for fclose, ferror, fflush, fmemopen, fprintf, fread, open_memstream, rewind, snprintf, FILE
+#include <stdlib.h>        // for free, realloc, strtod, strtof
+#include <string.h>        // for memcmp, memcpy, memmove, strcmp, strlen
+#include <sys/resource.h>  // for getrusage, rusage, RUSAGE_SELF
+#include <time.h>          // for clock_gettime, timespec, CLOCK_MONOTONIC
+#include "cli_errors.h"    // for CLI_BENCH_INPUT, CLI_BENCH_MEMORY, CLI_BENCH_MISMATCH, CLI_BENCH_ROUNDTRIP
+#include "errors.h"        // for Error, UNUSED, eof_or_error
+#include "infoset.h"       // for walkInfoset, InfosetBase, PState, PStateRefill, UState, RuntimeContext, new_context, free_context, numberSize, ERD
+#include "number_text.h"   // for format_number, parse_number, LIMIT_NUMBER_TEXT, NUMBER_OK
+#include "parsers.h"       // for parse_has_more_data, refill_from_memory, refill_from_stream
+#include "xml_reader.h"    // for xmlReaderMethods, XMLReader
+#include "xml_writer.h"    // for xmlWriterMethods, XMLWriter
+// clang-format on
+
+// Phase - the steps each record goes through, in order
+
+enum Phase
+{
+    PHASE_PARSE,
+    PHASE_PARSE_FILE,
+    PHASE_PARSE_FREAD,
+    PHASE_WRITE_XML,
+    PHASE_READ_XML,
+    PHASE_UNPARSE,
+    PHASE_FORMAT,
+    PHASE_PRINTF,
+    PHASE_READ_TEXT,
+    PHASE_STRTOD,
+    PHASE_NAME_HASH,
+    PHASE_NAME_STRCMP,
+    PHASE_ZZZ,
+};
+
+// Names of the phases in the report (parse-file and parse-fread time
+// parsing the record again from a stream, refilling the input buffer a
+// block at a time and with one fread per field the way parsers did
+// before they had an input buffer, while format and printf time only
+// formatting the record's numbers as text, with our formatters and
+// with printf the way the XML writer used to, and read-text and strtod
+// time only reading that text back, with our parsers and with strtod
+// and strtoimax the way the XML reader used to, and name-hash and
+// name-strcmp time only copying each tag's name and matching it against
+// its ERD, with hashes and with strcmp the way the XML reader used to)
+
+static const char *phase_names[PHASE_ZZZ] = {
+    "parse",  "parse-file", "parse-fread", "write-xml", "read-xml",  "unparse",
+    "format", "printf",     "read-text",   "strtod",    "name-hash", "name-strcmp",
+};
+
+// Get the current time in nanoseconds
+
+static uint64_t
+now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+// Read all of a stream into a growing heap buffer
+
+static const Error *
+read_all(FILE *input, char **data, size_t *length)
+{
+    size_t capacity = 0;
+    *data = NULL;
+    *length = 0;
+    while (true)
+    {
+        if (*length == capacity)
+        {
+            capacity = capacity ? 2 * capacity : LIMIT_BLOCK_SIZE;
+            char *bigger = realloc(*data, capacity);
+            if (!bigger)
+            {
+                static const Error error = {CLI_BENCH_MEMORY, {0}};
+                return &error;
+            }
+            *data = bigger;
+        }
+
+        const size_t count = fread(*data + *length, 1, capacity - *length, input);
+        *length += count;
+        if (count == 0)
+        {
+            if (ferror(input))
+            {
+                static const Error error = {CLI_BENCH_INPUT, {0}};
+                return &error;
+            }
+            return NULL;
+        }
+    }
+}
+
+// Refill input buffer from stream with only the bytes the next field
+// needs, calling fread once per field like parsers did before they had
+// an input buffer
+
+static const Error *
+refill_per_field(PState *pstate, size_t needed)
+{
+    // Move any unread bytes to the front of the input buffer
+    size_t unread = (size_t)(pstate->limit - pstate->next);
+    if (unread)
+    {
+        memmove(pstate->block, pstate->next, unread);
+    }
+    pstate->next = pstate->block;
+    pstate->limit = pstate->block + unread;
+
+    size_t count = fread(pstate->block + unread, 1, needed - unread, pstate->stream);
+    pstate->limit += count;
+    if (unread + count < needed)
+    {
+        return eof_or_error(pstate->stream);
+    }
+    return NULL;
+}
+
+// Parse a record again from a stream over its bytes, refilling the
+// input buffer with the given method, and add the time and bytes to
+// the phase's totals
+
+static const Error *
+bench_stream_parse(RuntimeContext *context, const char *record, size_t length, PStateRefill refill,
+                   uint64_t *ns, uint64_t *bytes)
+{
+    FILE *stream = fmemopen((void *)record, length, "r");
+    if (!stream)
+    {
+        static const Error error_memory = {CLI_BENCH_MEMORY, {0}};
+        return &error_memory;
+    }
+
+    InfosetBase *  root = context->root;
+    PState         pstate = {stream, 0, NULL, NULL, context, NULL, NULL, refill, {0}};
+    const uint64_t start = now_ns();
+    root->erd->initSelf(root);
+    root->erd->parseSelf(root, &pstate);
+    *ns += now_ns() - start;
+    *bytes += pstate.position;
+    fclose(stream);
+    return pstate.error;
+}
+
+// Throw away unparsed data (bench counts its bytes, not its contents)
+
+static const Error *
+flush_to_nowhere(UState *ustate)
+{
+    ustate->next = ustate->block;
+    ustate->limit = ustate->block + sizeof(ustate->block);
+    return NULL;
+}
+
+// NumberTexts - a record's numbers as text, each one stored as its
+// type code's byte followed by its NUL-terminated text
+
+typedef struct NumberTexts
+{
+    char * data;
+    size_t length;
+    size_t capacity;
+} NumberTexts;
+
+// NumberBench - infoset visitor with methods to format each number in
+// the infoset as text and throw the text away, counting its characters
+
+typedef struct NumberBench
+{
+    const VisitEventHandler handler;
+    RuntimeContext *        context;
+    bool                    check;  // whether to check that text reads back
+    size_t                  length; // number of characters formatted
+    NumberTexts *           texts;  // where to keep checked text, if anywhere
+} NumberBench;
+
+// Ignore the document's and complex elements' starts and ends
+
+static const Error *
+benchDocument(NumberBench *bench)
+{
+    UNUSED(bench);
+    return NULL;
+}
+
+static const Error *
+benchComplex(NumberBench *bench, const InfosetBase *base)
+{
+    UNUSED(bench);
+    UNUSED(base);
+    return NULL;
+}
+
+// Format a number with our formatters, checking that its text reads
+// back as the same number if asked to (any NaN reads back as any NaN)
+
+static const Error *
+benchFormatNumber(NumberBench *bench, const ERD *erd, const void *number)
+{
+    char         text[LIMIT_NUMBER_TEXT];
+    const size_t length = format_number(erd->typeCode, number, text);
+    bench->length += length;
+    if (!bench->check) return NULL;
+
+    char       same[sizeof(double)] = {0};
+    const bool nan = (erd->typeCode == PRIMITIVE_DOUBLE && isnan(*(const double *)number)) ||
+                     (erd->typeCode == PRIMITIVE_FLOAT && isnan(*(const float *)number));
+    if (parse_number(erd->typeCode, text, same) != NUMBER_OK ||
+        (nan ? length != 3 : memcmp(same, number, numberSize(erd->typeCode)) != 0))
+    {
+        // Copy the text since it lives only on our stack
+        Error *error = &bench->context->error;
+        memcpy(bench->context->errorText, text, length + 1);
+        error->code = CLI_BENCH_ROUNDTRIP;
+        error->arg.s = bench->context->errorText;
+        return error;
+    }
+
+    // Keep the text for the read-text and strtod phases
+    NumberTexts *texts = bench->texts;
+    if (texts->length + length + 2 > texts->capacity)
+    {
+        const size_t capacity = texts->capacity ? 2 * texts->capacity : LIMIT_BLOCK_SIZE;
+        char *       bigger = realloc(texts->data, capacity);
+        if (!bigger)
+        {
+            static const Error error_memory = {CLI_BENCH_MEMORY, {0}};
+            return &error_memory;
+        }
+        texts->data = bigger;
+        texts->capacity = capacity;
+    }
+    texts->data[texts->length++] = (char)erd->typeCode;
+    memcpy(texts->data + texts->length, text, length + 1);
+    texts->length += length + 1;
+    return NULL;
+}
+
+// Format a number with snprintf just like the XML writer did before it
+// had its own formatters
+
+static const Error *
+benchPrintfNumber(NumberBench *bench, const ERD *erd, const void *number)
+{
+    char text[LIMIT_NUMBER_TEXT];
+    int  length = 0;
+    switch (erd->typeCode)
+    {
+    case PRIMITIVE_BOOLEAN:
+        length = snprintf(text, sizeof(text), "%s", *(const bool *)number ? "true" : "false");
+        break;
+    case PRIMITIVE_FLOAT:
+        length = snprintf(text, sizeof(text), "%.9G", *(const float *)number);
+        break;
+    case PRIMITIVE_DOUBLE:
+        length = snprintf(text, sizeof(text), "%.17lG", *(const double *)number);
+        break;
+    case PRIMITIVE_INT16:
+        length = snprintf(text, sizeof(text), "%hi", *(const int16_t *)number);
+        break;
+    case PRIMITIVE_INT32:
+        length = snprintf(text, sizeof(text), "%i", *(const int32_t *)number);
+        break;
+    case PRIMITIVE_INT64:
+        length = snprintf(text, sizeof(text), "%li", *(const int64_t *)number);
+        break;
+    case PRIMITIVE_INT8:
+        length = snprintf(text, sizeof(text), "%hhi", *(const int8_t *)number);
+        break;
+    case PRIMITIVE_UINT16:
+        length = snprintf(text, sizeof(text), "%hu", *(const uint16_t *)number);
+        break;
+    case PRIMITIVE_UINT32:
+        length = snprintf(text, sizeof(text), "%u", *(const uint32_t *)number);
+        break;
+    case PRIMITIVE_UINT64:
+        length = snprintf(text, sizeof(text), "%lu", *(const uint64_t *)number);
+        break;
+    case PRIMITIVE_UINT8:
+        length = snprintf(text, sizeof(text), "%hhu", *(const uint8_t *)number);
+        break;
+    default:
+        break;
+    }
+    bench->length += length > 0 ? (size_t)length : 0;
+    return NULL;
+}
+
+// Convert a number's text with strtod, strtof, strtoimax, or strtoumax
+// and the same errno and range checks the XML reader made before it had
+// its own parsers
+
+static NumberParse
+benchStrtoNumber(enum TypeCode typeCode, const char *text, void *number)
+{
+    char *    endptr = NULL;
+    intmax_t  value = 0;
+    uintmax_t uvalue = 0;
+    bool      inRange = true;
+    errno = 0;
+    switch (typeCode)
+    {
+    case PRIMITIVE_BOOLEAN:
+        *(bool *)number = strcmp(text, "true") == 0 || strcmp(text, "1") == 0;
+        inRange = *(bool *)number || strcmp(text, "false") == 0 || strcmp(text, "0") == 0;
+        return inRange ? NUMBER_OK : NUMBER_NOT;
+    case PRIMITIVE_DOUBLE:
+        *(double *)number = strtod(text, &endptr);
+        break;
+    case PRIMITIVE_FLOAT:
+        *(float *)number = strtof(text, &endptr);
+        break;
+    case PRIMITIVE_INT16:
+        value = strtoimax(text, &endptr, 10);
+        inRange = value >= INT16_MIN && value <= INT16_MAX;
+        *(int16_t *)number = (int16_t)value;
+        break;
+    case PRIMITIVE_INT32:
+        value = strtoimax(text, &endptr, 10);
+        inRange = value >= INT32_MIN && value <= INT32_MAX;
+        *(int32_t *)number = (int32_t)value;
+        break;
+    case PRIMITIVE_INT64:
+        *(int64_t *)number = strtoimax(text, &endptr, 10);
+        break;
+    case PRIMITIVE_INT8:
+        value = strtoimax(text, &endptr, 10);
+        inRange = value >= INT8_MIN && value <= INT8_MAX;
+        *(int8_t *)number = (int8_t)value;
+        break;
+    case PRIMITIVE_UINT16:
+        uvalue = strtoumax(text, &endptr, 10);
+        inRange = uvalue <= UINT16_MAX;
+        *(uint16_t *)number = (uint16_t)uvalue;
+        break;
+    case PRIMITIVE_UINT32:
+        uvalue = strtoumax(text, &endptr, 10);
+        inRange = uvalue <= UINT32_MAX;
+        *(uint32_t *)number = (uint32_t)uvalue;
+        break;
+    case PRIMITIVE_UINT64:
+        *(uint64_t *)number = strtoumax(text, &endptr, 10);
+        break;
+    case PRIMITIVE_UINT8:
+        uvalue = strtoumax(text, &endptr, 10);
+        inRange = uvalue <= UINT8_MAX;
+        *(uint8_t *)number = (uint8_t)uvalue;
+        break;
+    default:
+        return NUMBER_TYPE;
+    }
+
+    if (errno != 0 || !inRange)
+    {
+        return NUMBER_RANGE;
+    }
+    if (endptr == text)
+    {
+        return NUMBER_EMPTY;
+    }
+    return *endptr ? NUMBER_NOT : NUMBER_OK;
+}
+
+// Read back a record's number texts with our parsers or with strtod and
+// friends, counting the characters read and how many texts didn't
+// read back (strtod calls subnormals out of range)
+
+static size_t
+bench_read_texts(const NumberTexts *texts, bool baseline, size_t *length)
+{
+    size_t      failures = 0;
+    const char *next = texts->data;
+    const char *limit = texts->data + texts->length;
+    while (next < limit)
+    {
+        const enum TypeCode typeCode = (enum TypeCode)(unsigned char)*next++;
+        const size_t        text_length = strlen(next);
+        char                number[sizeof(double)];
+        const NumberParse   result =
+            baseline ? benchStrtoNumber(typeCode, next, number) : parse_number(typeCode, next, number);
+        failures += result != NUMBER_OK;
+        *length += text_length;
+        next += text_length + 1;
+    }
+    return failures;
+}
+
+// NumberBench methods for formatting with our formatters or printf
+
+static const VisitEventHandler formatBenchMethods = {
+    (VisitStartDocument)&benchDocument,   (VisitEndDocument)&benchDocument,
+    (VisitStartComplex)&benchComplex,     (VisitEndComplex)&benchComplex,
+    (VisitNumberElem)&benchFormatNumber,  NULL,
+};
+
+static const VisitEventHandler printfBenchMethods = {
+    (VisitStartDocument)&benchDocument,   (VisitEndDocument)&benchDocument,
+    (VisitStartComplex)&benchComplex,     (VisitEndComplex)&benchComplex,
+    (VisitNumberElem)&benchPrintfNumber,  NULL,
+};
+
+// NameBench - infoset visitor with methods to copy each start and end
+// tag's name the way the XML reader reads it and match it against the
+// element's ERD, either hashing it as it copies and comparing hashes
+// and lengths first like the reader does or comparing it with strcmp
+// like the reader used to, counting the names' characters
+
+typedef struct NameBench
+{
+    const VisitEventHandler handler;
+    bool                    hashed;                  // whether to match with hashes or strcmp
+    size_t                  length;                  // number of characters matched
+    size_t                  mismatches;              // number of names which didn't match (keeps compares)
+    char                    name[LIMIT_NAME_LENGTH]; // copy of name being matched
+} NameBench;
+
+// Copy an element's name and match the copy against its ERD
+
+static void
+benchMatchName(NameBench *bench, const ERD *erd)
+{
+    const NamedQName *qname = &erd->namedQName;
+    const char *      next = qname->name;
+    size_t            length = 0;
+    if (bench->hashed)
+    {
+        uint32_t hash = NAME_HASH_BASIS;
+        while (*next)
+        {
+            const char c = *next++;
+            bench->name[length++] = c;
+            hash = (hash ^ (uint8_t)c) * NAME_HASH_PRIME;
+        }
+        bench->mismatches += hash != qname->nameHash || length != qname->nameLength ||
+                             memcmp(bench->name, qname->name, length) != 0;
+    }
+    else
+    {
+        while (*next)
+        {
+            bench->name[length++] = *next++;
+        }
+        bench->name[length] = 0;
+        bench->mismatches += strcmp(bench->name, qname->name) != 0;
+    }
+    bench->length += length;
+}
+
+// Match complex and simple elements' names (once for each tag)
+
+static const Error *
+benchNameComplex(NameBench *bench, const InfosetBase *base)
+{
+    benchMatchName(bench, base->erd);
+    return NULL;
+}
+
+static const Error *
+benchNameNumber(NameBench *bench, const ERD *erd, const void *number)
+{
+    UNUSED(number);
+    benchMatchName(bench, erd);
+    benchMatchName(bench, erd);
+    return NULL;
+}
+
+// NameBench methods for matching names with hashes or strcmp
+
+static const VisitEventHandler nameBenchMethods = {
+    (VisitStartDocument)&benchDocument,   (VisitEndDocument)&benchDocument,
+    (VisitStartComplex)&benchNameComplex, (VisitEndComplex)&benchNameComplex,
+    (VisitNumberElem)&benchNameNumber,    NULL,
+};
+
+// Run one record through every phase, adding each phase's time and
+// bytes to the totals
+
+static const Error *
+bench_record(PState *pstate, FILE *xml, char **xmlData, size_t *xmlLength, NumberTexts *texts, uint64_t *ns,
+             uint64_t *bytes)
+{
+    RuntimeContext *context = pstate->context;
+    InfosetBase *   root = context->root;
+
+    // Parse the record
+    const char *record = pstate->next;
+    uint64_t    start = now_ns();
+    root->erd->initSelf(root);
+    pstate->position = 0;
+    root->erd->parseSelf(root, pstate);
+    uint64_t end = now_ns();
+    ns[PHASE_PARSE] += end - start;
+    bytes[PHASE_PARSE] += pstate->position;
+    if (pstate->error) return pstate->error;
+
+    // Parse the record again from a stream, refilling a block at a time
+    // and then a field at a time
+    const Error *error = bench_stream_parse(context, record, pstate->position, &refill_from_stream,
+                                            &ns[PHASE_PARSE_FILE], &bytes[PHASE_PARSE_FILE]);
+    if (error) return error;
+    error = bench_stream_parse(context, record, pstate->position, &refill_per_field, &ns[PHASE_PARSE_FREAD],
+                               &bytes[PHASE_PARSE_FREAD]);
+    if (error) return error;
+
+    // Write the record's infoset to XML in memory
+    XMLWriter xmlWriter = {xmlWriterMethods, xml, context, NULL, {0}};
+    rewind(xml);
+    start = now_ns();
+    error = walkInfoset((VisitEventHandler *)&xmlWriter, context);
+    if (!error && fflush(xml) != 0)
+    {
+        static const Error error_memory = {CLI_BENCH_MEMORY, {0}};
+        error = &error_memory;
+    }
+    end = now_ns();
+    ns[PHASE_WRITE_XML] += end - start;
+    bytes[PHASE_WRITE_XML] += *xmlLength;
+    if (error) return error;
+
+    // Read the XML back into the record's infoset
+    FILE *input = fmemopen(*xmlData, *xmlLength, "r");
+    if (!input)
+    {
+        static const Error error_memory = {CLI_BENCH_MEMORY, {0}};
+        return &error_memory;
+    }
+    XMLReader xmlReader = {xmlReaderMethods, input, context, NULL, NULL, false, 0, 0, {0}, {0}, {0}};
+    start = now_ns();
+    error = walkInfoset((VisitEventHandler *)&xmlReader, context);
+    end = now_ns();
+    ns[PHASE_READ_XML] += end - start;
+    bytes[PHASE_READ_XML] += *xmlLength;
+    fclose(input);
+    if (error) return error;
+
+    // Unparse the infoset, which must give back as many bytes as parsing
+    // the record took
+    UState ustate = {NULL, 0, NULL, NULL, context, NULL, NULL, &flush_to_nowhere, {0}};
+    start = now_ns();
+    root->erd->unparseSelf(root, &ustate);
+    end = now_ns();
+    ns[PHASE_UNPARSE] += end - start;
+    bytes[PHASE_UNPARSE] += ustate.position;
+    if (ustate.error) return ustate.error;
+    if (ustate.position != pstate->position)
+    {
+        Error *error_mismatch = &context->error;
+        error_mismatch->code = CLI_BENCH_MISMATCH;
+        error_mismatch->arg.d64 = (int64_t)ustate.position;
+        return error_mismatch;
+    }
+
+    // Format the infoset's numbers with our formatters, then with printf,
+    // and then check that our formatters' text reads back untimed
+    NumberBench formatBench = {formatBenchMethods, context, false, 0, NULL};
+    start = now_ns();
+    error = walkInfoset((VisitEventHandler *)&formatBench, context);
+    end = now_ns();
+    ns[PHASE_FORMAT] += end - start;
+    bytes[PHASE_FORMAT] += formatBench.length;
+    if (error) return error;
+
+    NumberBench printfBench = {printfBenchMethods, context, false, 0, NULL};
+    start = now_ns();
+    error = walkInfoset((VisitEventHandler *)&printfBench, context);
+    end = now_ns();
+    ns[PHASE_PRINTF] += end - start;
+    bytes[PHASE_PRINTF] += printfBench.length;
+    if (error) return error;
+
+    NumberBench checkBench = {formatBenchMethods, context, true, 0, texts};
+    texts->length = 0;
+    error = walkInfoset((VisitEventHandler *)&checkBench, context);
+    if (error) return error;
+
+    // Read the checked text back with our parsers, then with strtod
+    start = now_ns();
+    bench_read_texts(texts, false, &bytes[PHASE_READ_TEXT]);
+    end = now_ns();
+    ns[PHASE_READ_TEXT] += end - start;
+
+    start = now_ns();
+    bench_read_texts(texts, true, &bytes[PHASE_STRTOD]);
+    end = now_ns();
+    ns[PHASE_STRTOD] += end - start;
+
+    // Match every tag's name with hashes, then with strcmp
+    NameBench hashBench = {nameBenchMethods, true, 0, 0, {0}};
+    start = now_ns();
+    walkInfoset((VisitEventHandler *)&hashBench, context);
+    end = now_ns();
+    ns[PHASE_NAME_HASH] += end - start;
+    bytes[PHASE_NAME_HASH] += hashBench.length;
+
+    NameBench strcmpBench = {nameBenchMethods, false, 0, 0, {0}};
+    start = now_ns();
+    walkInfoset((VisitEventHandler *)&strcmpBench, context);
+    end = now_ns();
+    ns[PHASE_NAME_STRCMP] += end - start;
+    bytes[PHASE_NAME_STRCMP] += strcmpBench.length;
+    return NULL;
+}
+
+// bench_phases - read all of input into memory, then make runs passes
+// over its records, timing how long each record takes to parse, write
+// to XML, read back from XML, and unparse, and how long its numbers
+// take to format as text with our formatters (checking that the text
+// reads back as the same numbers) and with printf, and write a report
+// of each phase's ns/record and throughput plus the peak RSS to output
+
+const Error *
+bench_phases(FILE *input, FILE *output, size_t runs)
+{
+    char *       data = NULL;
+    size_t       length = 0;
+    char *       xmlData = NULL;
+    size_t       xmlLength = 0;
+    FILE *       xml = NULL;
+    NumberTexts  texts = {NULL, 0, 0};
+    const Error *error = read_all(input, &data, &length);
+
+    RuntimeContext *context = NULL;
+    if (!error)
+    {
+        context = new_context();
+        xml = open_memstream(&xmlData, &xmlLength);
+        if (!context || !xml)
+        {
+            static const Error error_memory = {CLI_BENCH_MEMORY, {0}};
+            error = &error_memory;
+        }
+    }
+
+    // Run every record through every phase, runs times over
+    uint64_t ns[PHASE_ZZZ] = {0};
+    uint64_t bytes[PHASE_ZZZ] = {0};
+    size_t   records = 0;
+    size_t   run;
+    for (run = 0; run < runs && !error; run++)
+    {
+        PState pstate = {NULL, 0, NULL, NULL, context, data, data + length, &refill_from_memory, {0}};
+        while (!error && parse_has_more_data(&pstate))
+        {
+            error = bench_record(&pstate, xml, &xmlData, &xmlLength, &texts, ns, bytes);
+            records++;
+        }
+        error = error ? error : pstate.error;
+    }
+
+    // Report each phase's average time and throughput
+    if (!error)
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        const double per_record = records ? 1 / (double)records : 0;
+        fprintf(output, "bench: %zu records, %zu bytes, %zu runs\n", records / runs, length, runs);
+        fprintf(output, "%-11s %12s %12s %14s\n", "phase", "ns/record", "MB/s", "records/s");
+        size_t phase;
+        for (phase = 0; phase < PHASE_ZZZ; phase++)
+        {
+            const double seconds = (double)ns[phase] / 1e9;
+            const double rate = seconds > 0 ? 1 / seconds : 0;
+            fprintf(output, "%-11s %12.0f %12.1f %14.0f\n", phase_names[phase],
+                    (double)ns[phase] * per_record, (double)bytes[phase] * rate / 1e6,
+                    (double)records * rate);
+        }
+        fprintf(output, "peak RSS: %ld KB\n", usage.ru_maxrss);
+    }
+
+    // Keep our context if our error refers to it (program will exit)
+    if (xml)
+    {
+        fclose(xml);
+    }
+    free(texts.data);
+    free(xmlData);
+    free(data);
+    if (!error)
+    {
+        free_context(context);
+    }
+    return error;
+}
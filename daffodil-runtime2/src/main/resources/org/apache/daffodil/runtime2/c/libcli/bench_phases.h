@@ -0,0 +1,40 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BENCH_PHASES_H
+#define BENCH_PHASES_H
+
+// clang-format off
+#include <stddef.h>  // for size_t
+#include <stdio.h>   // for FILE
+#include "errors.h"  // for Error
+// clang-format on
+
+// bench_phases - read all of input into memory, then make runs passes
+// over its records, timing how long each record takes to parse (from
+// memory, and from a stream a block at a time and with one fread per
+// field), write to XML, read back from XML, and unparse, and how long
+// its numbers take to format as text with our formatters (checking
+// that the text reads back as the same numbers) and with printf and
+// to read back from that text with our parsers and with strtod, and
+// how long its tags' names take to match their ERDs with hashes and
+// with strcmp, and write a report of each phase's ns/record and
+// throughput plus the peak RSS to output
+
+extern const Error *bench_phases(FILE *input, FILE *output, size_t runs);
+
+#endif // BENCH_PHASES_H
@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "binary_reader.h"
+#include <stdbool.h>        // for bool
+#include <stdint.h>         // for uint8_t, uint32_t
+#include <stdio.h>          // for fread, feof, ferror
+#include <string.h>         // for memcpy, memcmp, memmove
+#include "binary_writer.h"  // for BINARY_MAGIC, BINARY_VERSION, BINARY_START, BINARY_END
+#include "cli_errors.h"     // for CLI_BINARY_GONE, CLI_BINARY_HEADER, CLI_BINARY_INPUT, CLI_BINARY_LEFT, CLI_BINARY_MISMATCH
+#include "errors.h"         // for Error
+// clang-format on
+
+// Refill the input buffer until it holds at least the given number of
+// unread bytes, returning an error if the stream has no more bytes
+
+static const Error *
+binaryFill(BinaryReader *reader, size_t needed)
+{
+    size_t unread = (size_t)(reader->limit - reader->next);
+    if (unread >= needed)
+    {
+        return NULL;
+    }
+
+    // Move any unread bytes to the front of the input buffer
+    memmove(reader->block, reader->next, unread);
+    reader->next = reader->block;
+    reader->limit = reader->block + unread;
+
+    // Read until we have enough bytes or reach the end of the stream
+    while (unread < needed && !feof(reader->stream))
+    {
+        const size_t count = fread(reader->block + unread, 1, sizeof(reader->block) - unread, reader->stream);
+        reader->limit += count;
+        unread += count;
+        if (ferror(reader->stream))
+        {
+            static const Error error = {CLI_BINARY_INPUT, {0}};
+            return &error;
+        }
+    }
+    if (unread < needed)
+    {
+        static const Error error = {CLI_BINARY_GONE, {0}};
+        return &error;
+    }
+    return NULL;
+}
+
+// Report a mismatch between the binary data and the expected element
+
+static const Error *
+binaryMismatch(BinaryReader *reader, const ERD *erd)
+{
+    Error *error = &reader->context->error;
+    error->code = CLI_BINARY_MISMATCH;
+    error->arg.s = erd->namedQName.name;
+    return error;
+}
+
+// Consume an element's ID and length byte, checking that they match
+// the expected element and length (caller must have filled them)
+
+static const Error *
+binaryReadTag(BinaryReader *reader, const ERD *erd, uint8_t length)
+{
+    uint32_t id = 0;
+    memcpy(&id, reader->next, sizeof(id));
+    if (id != erd->namedQName.nameHash || reader->next[sizeof(id)] != length)
+    {
+        return binaryMismatch(reader, erd);
+    }
+    reader->next += sizeof(id) + 1;
+    return NULL;
+}
+
+// Start reading binary data from the stream, checking its header
+
+static const Error *
+binaryStartDocument(BinaryReader *reader)
+{
+    const uint32_t version = BINARY_VERSION;
+    reader->next = reader->block;
+    reader->limit = reader->block;
+
+    const Error *error = binaryFill(reader, 4 + sizeof(version));
+    if (!error)
+    {
+        if (memcmp(reader->next, BINARY_MAGIC, 4) != 0 ||
+            memcmp(reader->next + 4, &version, sizeof(version)) != 0)
+        {
+            static const Error error_header = {CLI_BINARY_HEADER, {0}};
+            return &error_header;
+        }
+        reader->next += 4 + sizeof(version);
+    }
+    return error;
+}
+
+// Check that we have consumed all of the binary data
+
+static const Error *
+binaryEndDocument(BinaryReader *reader)
+{
+    if (binaryFill(reader, 1) == NULL)
+    {
+        static const Error error_left = {CLI_BINARY_LEFT, {0}};
+        return &error_left;
+    }
+    if (ferror(reader->stream))
+    {
+        static const Error error_input = {CLI_BINARY_INPUT, {0}};
+        return &error_input;
+    }
+    return NULL;
+}
+
+// Consume a complex element's start marker
+
+static const Error *
+binaryStartComplex(BinaryReader *reader, const InfosetBase *base)
+{
+    const Error *error = binaryFill(reader, sizeof(uint32_t) + 1);
+    if (!error)
+    {
+        error = binaryReadTag(reader, base->erd, BINARY_START);
+    }
+    return error;
+}
+
+// Consume a complex element's end marker
+
+static const Error *
+binaryEndComplex(BinaryReader *reader, const InfosetBase *base)
+{
+    const Error *error = binaryFill(reader, sizeof(uint32_t) + 1);
+    if (!error)
+    {
+        error = binaryReadTag(reader, base->erd, BINARY_END);
+    }
+    return error;
+}
+
+// Read a number's raw bytes after its element's ID and length (reads
+// a boolean from a single byte which must be 0 or 1)
+
+static const Error *
+binaryNumberElem(BinaryReader *reader, const ERD *erd, void *number)
+{
+    const bool   boolean = erd->typeCode == PRIMITIVE_BOOLEAN;
+    const size_t size = boolean ? 1 : numberSize(erd->typeCode);
+    const Error *error = binaryFill(reader, sizeof(uint32_t) + 1 + size);
+    if (!error)
+    {
+        error = binaryReadTag(reader, erd, (uint8_t)size);
+    }
+    if (error)
+    {
+        return error;
+    }
+
+    if (boolean)
+    {
+        if (*reader->next > 1)
+        {
+            return binaryMismatch(reader, erd);
+        }
+        *(bool *)number = *reader->next;
+    }
+    else
+    {
+        memcpy(number, reader->next, size);
+    }
+    reader->next += size;
+    return NULL;
+}
+
+// Initialize a struct with our visitor event handler methods (reads
+// runs of numbers one at a time through binaryNumberElem)
+
+const VisitEventHandler binaryReaderMethods = {
+    (VisitStartDocument)&binaryStartDocument, (VisitEndDocument)&binaryEndDocument,
+    (VisitStartComplex)&binaryStartComplex,   (VisitEndComplex)&binaryEndComplex,
+    (VisitNumberElem)&binaryNumberElem,       NULL,
+};
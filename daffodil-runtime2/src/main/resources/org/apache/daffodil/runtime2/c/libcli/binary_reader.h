@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BINARY_READER_H
+#define BINARY_READER_H
+
+// clang-format off
+#include <stdint.h>   // for uint8_t
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for LIMIT_BLOCK_SIZE
+#include "infoset.h"  // for VisitEventHandler, RuntimeContext
+// clang-format on
+
+// BinaryReader - infoset visitor with methods to read the binary
+// infoset format described in binary_writer.h (reads from the stream
+// into its input buffer only as it visits the infoset, checking each
+// element's ID and length against the ERD it expects)
+
+typedef struct BinaryReader
+{
+    const VisitEventHandler handler;
+    FILE *                  stream;
+    RuntimeContext *        context;
+    const uint8_t *         next;                    // next unread byte in input buffer
+    const uint8_t *         limit;                   // one past last unread byte in input buffer
+    uint8_t                 block[LIMIT_BLOCK_SIZE]; // input buffer's storage
+} BinaryReader;
+
+// BinaryReader methods to pass to walkInfoset method
+
+extern const VisitEventHandler binaryReaderMethods;
+
+#endif // BINARY_READER_H
@@ -0,0 +1,185 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "binary_writer.h"
+#include <stdbool.h>     // for bool
+#include <stdint.h>      // for uint8_t, uint32_t
+#include <stdio.h>       // for fwrite
+#include <string.h>      // for memcpy
+#include "cli_errors.h"  // for CLI_BINARY_WRITE
+#include "errors.h"      // for Error
+// clang-format on
+
+// Write the output buffer's bytes to the stream, emptying the buffer
+
+static const Error *
+binaryFlush(BinaryWriter *writer)
+{
+    const size_t length = (size_t)(writer->next - writer->block);
+    const size_t count = fwrite(writer->block, 1, length, writer->stream);
+    writer->next = writer->block;
+    if (count < length)
+    {
+        static const Error error = {CLI_BINARY_WRITE, {0}};
+        return &error;
+    }
+    return NULL;
+}
+
+// Make room for the given number of bytes in the output buffer,
+// flushing it if it doesn't have that much room left
+
+static const Error *
+binaryReserve(BinaryWriter *writer, size_t length)
+{
+    if ((size_t)(writer->block + sizeof(writer->block) - writer->next) < length)
+    {
+        return binaryFlush(writer);
+    }
+    return NULL;
+}
+
+// Write an element's ID and length byte into the output buffer
+// (caller must have reserved room for them)
+
+static void
+binaryWriteTag(BinaryWriter *writer, const ERD *erd, uint8_t length)
+{
+    memcpy(writer->next, &erd->namedQName.nameHash, sizeof(uint32_t));
+    writer->next[sizeof(uint32_t)] = length;
+    writer->next += sizeof(uint32_t) + 1;
+}
+
+// Start a new binary document with its header
+
+static const Error *
+binaryStartDocument(BinaryWriter *writer)
+{
+    const uint32_t version = BINARY_VERSION;
+    writer->next = writer->block;
+    memcpy(writer->next, BINARY_MAGIC, 4);
+    memcpy(writer->next + 4, &version, sizeof(version));
+    writer->next += 4 + sizeof(version);
+    return NULL;
+}
+
+// End the binary document and write the rest of it to the stream
+
+static const Error *
+binaryEndDocument(BinaryWriter *writer)
+{
+    return binaryFlush(writer);
+}
+
+// Write a complex element's start marker
+
+static const Error *
+binaryStartComplex(BinaryWriter *writer, const InfosetBase *base)
+{
+    const Error *error = binaryReserve(writer, sizeof(uint32_t) + 1);
+    if (!error)
+    {
+        binaryWriteTag(writer, base->erd, BINARY_START);
+    }
+    return error;
+}
+
+// Write a complex element's end marker
+
+static const Error *
+binaryEndComplex(BinaryWriter *writer, const InfosetBase *base)
+{
+    const Error *error = binaryReserve(writer, sizeof(uint32_t) + 1);
+    if (!error)
+    {
+        binaryWriteTag(writer, base->erd, BINARY_END);
+    }
+    return error;
+}
+
+// Write a number's raw bytes after its element's ID and length (writes
+// a boolean as a single 0 or 1 byte whatever size bool has)
+
+static const Error *
+binaryNumberElem(BinaryWriter *writer, const ERD *erd, const void *number)
+{
+    const size_t size = erd->typeCode == PRIMITIVE_BOOLEAN ? 1 : numberSize(erd->typeCode);
+    const Error *error = binaryReserve(writer, sizeof(uint32_t) + 1 + size);
+    if (!error)
+    {
+        binaryWriteTag(writer, erd, (uint8_t)size);
+        if (erd->typeCode == PRIMITIVE_BOOLEAN)
+        {
+            *writer->next = *(const bool *)number ? 1 : 0;
+        }
+        else
+        {
+            memcpy(writer->next, number, size);
+        }
+        writer->next += size;
+    }
+    return error;
+}
+
+// Write a run of adjacent numbers of the same type, reserving room
+// for as many of them at once as the output buffer can hold
+
+static const Error *
+binaryNumberRun(BinaryWriter *writer, const ERD *const *erds, const void *numbers, size_t count)
+{
+    const enum TypeCode typeCode = erds[0]->typeCode;
+    if (typeCode == PRIMITIVE_BOOLEAN)
+    {
+        const Error *error = NULL;
+        size_t       i;
+        for (i = 0; i < count && !error; i++)
+        {
+            error = binaryNumberElem(writer, erds[i], (const bool *)numbers + i);
+        }
+        return error;
+    }
+
+    const size_t   size = numberSize(typeCode);
+    const size_t   each = sizeof(uint32_t) + 1 + size;
+    const uint8_t *number = numbers;
+    size_t         i = 0;
+    while (i < count)
+    {
+        const Error *error = binaryReserve(writer, each);
+        if (error) return error;
+
+        // Write as many numbers as fit without checking room for each
+        const size_t room = (size_t)(writer->block + sizeof(writer->block) - writer->next) / each;
+        const size_t last = count - i < room ? count : i + room;
+        for (; i < last; i++)
+        {
+            binaryWriteTag(writer, erds[i], (uint8_t)size);
+            memcpy(writer->next, number + i * size, size);
+            writer->next += size;
+        }
+    }
+    return NULL;
+}
+
+// Initialize a struct with our visitor event handler methods
+
+const VisitEventHandler binaryWriterMethods = {
+    (VisitStartDocument)&binaryStartDocument, (VisitEndDocument)&binaryEndDocument,
+    (VisitStartComplex)&binaryStartComplex,   (VisitEndComplex)&binaryEndComplex,
+    (VisitNumberElem)&binaryNumberElem,       (VisitNumberRun)&binaryNumberRun,
+};
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BINARY_WRITER_H
+#define BINARY_WRITER_H
+
+// clang-format off
+#include <stdint.h>   // for uint8_t
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for LIMIT_BLOCK_SIZE
+#include "infoset.h"  // for VisitEventHandler, RuntimeContext
+// clang-format on
+
+// Binary infoset format - a compact infoset for other C programs which
+// needs no text formatting or parsing.  A document starts with the
+// 4-byte magic BINARY_MAGIC and a 4-byte BINARY_VERSION in the writer's
+// native byte order (a reader on a host with a different byte order
+// sees a different version and refuses the data).  Each element then
+// follows in document order as its 4-byte ID (its ERD's nameHash in
+// native byte order) and a 1-byte length: a simple element's length
+// counts the raw native-endian bytes of its value which follow it,
+// while BINARY_START and BINARY_END mark a complex element's start and
+// end.  Choices need no marker since only their chosen branch appears.
+// The ID is only a checksum of the element's name, not a unique
+// identifier: elements with the same name share an ID and different
+// names can collide, so a reader must walk the infoset in lockstep and
+// check each ID against the ERD it expects next, which catches data
+// written for another schema or out of step but can't place an
+// element by its ID alone.
+
+#define BINARY_MAGIC "DAFB"
+#define BINARY_VERSION 1u
+
+enum BinaryMarker
+{
+    BINARY_START = 0xFE, // length byte of a complex element's start
+    BINARY_END = 0xFF,   // length byte of a complex element's end
+};
+
+// BinaryWriter - infoset visitor with methods to output the binary
+// infoset format (writes into its output buffer as it visits the
+// infoset and writes the output buffer to the stream only when the
+// buffer fills up or the document ends)
+
+typedef struct BinaryWriter
+{
+    const VisitEventHandler handler;
+    FILE *                  stream;
+    RuntimeContext *        context;
+    uint8_t *               next;                    // next unwritten byte in output buffer
+    uint8_t                 block[LIMIT_BLOCK_SIZE]; // output buffer's storage
+} BinaryWriter;
+
+// BinaryWriter methods to pass to walkInfoset method
+
+extern const VisitEventHandler binaryWriterMethods;
+
+#endif // BINARY_WRITER_H
@@ -33,53 +33,101 @@ static const ErrorLookup *
 error_lookup(uint8_t code)
 {
     static const ErrorLookup table[CLI_ZZZ - ERR_ZZZ] = {
+        {CLI_BENCH_INPUT, "unable to read bench data from input file\n", FIELD_ZZZ},
+        {CLI_BENCH_MEMORY, "error allocating memory for bench\n", FIELD_ZZZ},
+        {CLI_BENCH_MISMATCH,
+         "unparsed %" PRId64 " bytes, not as many as record's parse consumed\n",
+         FIELD_D64},
+        {CLI_BENCH_ROUNDTRIP, "formatted number '%s' reads back as a different number\n", FIELD_S},
+        {CLI_BINARY_GONE, "ran out of binary infoset data\n", FIELD_ZZZ},
+        {CLI_BINARY_HEADER, "found no binary infoset header for this host's byte order\n", FIELD_ZZZ},
+        {CLI_BINARY_INPUT, "unable to read binary infoset data from input file\n", FIELD_ZZZ},
+        {CLI_BINARY_LEFT, "did not consume all of the binary infoset data\n", FIELD_ZZZ},
+        {CLI_BINARY_MISMATCH, "found mismatch between binary infoset data and infoset '%s'\n", FIELD_S},
+        {CLI_BINARY_WRITE, "error writing binary infoset\n", FIELD_ZZZ},
+        {CLI_COLUMN_LAYOUT, "found record whose elements differ from first record's at '%s'\n", FIELD_S},
+        {CLI_COLUMN_MEMORY, "error allocating memory for columns\n", FIELD_ZZZ},
+        {CLI_COLUMN_NAME, "path to element '%s' too long for a column name\n", FIELD_S},
+        {CLI_COLUMN_WRITE, "error writing columns\n", FIELD_ZZZ},
         {CLI_FILE_CLOSE, "error closing file\n", FIELD_ZZZ},
         {CLI_FILE_OPEN, "error opening file '%s'\n", FIELD_S},
         {CLI_HELP_USAGE,
          "Usage: %s [OPTION...] <command> [infile]\n"
          "\n"
          "Options:\n"
-         "  -h            Give this help list\n"
-         "  -I            Infoset type to write or read. Must be 'xml'\n"
-         "  -o            Write output to file. If not given or is -,\n"
-         "                output is written to stdout\n"
-         "  -V            Print program version\n"
+         "  -h, --help          Give this help list\n"
+         "  -I, --infoset-type  Infoset type to write or read. Must be 'xml',\n"
+         "                      'json', 'binary', 'columns', or 'null'\n"
+         "  -j, --jobs          Parse records on this many threads when streaming\n"
+         "                      a fixed-length root element from a file\n"
+         "  -m, --mmap          Memory-map infile when parsing. Falls back to\n"
+         "                      reading stdin or pipes as a stream\n"
+         "  -o, --output        Write output to file. If not given or is -,\n"
+         "                      output is written to stdout\n"
+         "  -r, --runs          Make this many passes over infile's records\n"
+         "                      when benchmarking (default 10)\n"
+         "      --stream        When left over data exists, parse again with\n"
+         "                      remaining data, separating infosets by a NUL\n"
+         "                      character\n"
+         "  -t, --timing        Report bytes/s and records/s to stderr (with\n"
+         "                      -I null, parsing alone is timed)\n"
+         "  -V, --version       Print program version\n"
          "\n"
          "Commands:\n"
-         "  parse         Parse a data file to an infoset file\n"
-         "  unparse       Unparse an infoset file to a data file\n"
+         "  bench               Time parsing, writing XML, reading XML, and\n"
+         "                      unparsing each record of a data file\n"
+         "  parse               Parse a data file to an infoset file\n"
+         "  serve               Parse and unparse framed requests from stdin\n"
+         "                      until EOF, replying to each on stdout\n"
+         "  unparse             Unparse an infoset file to a data file\n"
          "\n"
          "Argument:\n"
-         "  infile        Input file to parse or unparse. If not specified,\n"
-         "                or a value of -, reads from stdin\n",
+         "  infile              Input file to parse, unparse, or bench. If not\n"
+         "                      specified, or a value of -, reads from stdin\n",
+         FIELD_S},
+        {CLI_INFOSET_ERD, "unexpected ERD typeCode %" PRId64 " while reading infoset data\n", FIELD_D64},
+        {CLI_INFOSET_UNPARSE,
+         "unable to unparse infoset type '%s', only 'xml', 'json', or 'binary'\n",
          FIELD_S},
         {CLI_INVALID_COMMAND, "invalid command -- '%s'\n" USAGE, FIELD_S},
         {CLI_INVALID_INFOSET, "invalid infoset type -- '%s'\n" USAGE, FIELD_S},
+        {CLI_INVALID_JOBS, "invalid number of jobs -- '%s'\n" USAGE, FIELD_S},
+        {CLI_INVALID_LONG_OPTION, "invalid option -- '%s'\n" USAGE, FIELD_S},
         {CLI_INVALID_OPTION, "invalid option -- '%c'\n" USAGE, FIELD_C},
+        {CLI_INVALID_RUNS, "invalid number of runs -- '%s'\n" USAGE, FIELD_S},
+        {CLI_JSON_GONE, "ran out of JSON data\n", FIELD_ZZZ},
+        {CLI_JSON_INPUT, "unable to read JSON data from input file\n", FIELD_ZZZ},
+        {CLI_JSON_LEFT, "did not consume all of the JSON data\n", FIELD_ZZZ},
+        {CLI_JSON_MISMATCH, "found mismatch between JSON data and infoset '%s'\n", FIELD_S},
+        {CLI_JSON_SYNTAX, "found unexpected character '%c' in JSON data\n", FIELD_C},
+        {CLI_JSON_WRITE, "error writing JSON document\n", FIELD_ZZZ},
+        {CLI_LIBRARY_INFOSET, "unknown infoset type '%s', only 'xml', 'json', or 'binary'\n", FIELD_S},
+        {CLI_LIBRARY_MEMORY, "error allocating memory for buffers\n", FIELD_ZZZ},
         {CLI_MISSING_COMMAND, "missing command\n" USAGE, FIELD_ZZZ},
         {CLI_MISSING_VALUE, "option requires an argument -- '%c'\n" USAGE, FIELD_C},
+        {CLI_NEW_CONTEXT, "error allocating runtime context\n", FIELD_ZZZ},
+        {CLI_PARALLEL_MEMORY, "error allocating memory for parallel parsing\n", FIELD_ZZZ},
+        {CLI_PARALLEL_THREAD, "error creating thread for parallel parsing\n", FIELD_ZZZ},
         {CLI_PROGRAM_ERROR,
          "unexpected getopt code %" PRId64 "\n"
          "Check for program error\n",
          FIELD_D64},
         {CLI_PROGRAM_VERSION, "%s\n", FIELD_S},
-        {CLI_STACK_EMPTY, "stack empty, stopping program\n", FIELD_ZZZ},
-        {CLI_STACK_OVERFLOW, "stack overflow, stopping program\n", FIELD_ZZZ},
-        {CLI_STACK_UNDERFLOW, "stack underflow, stopping program\n", FIELD_ZZZ},
-        {CLI_STRTOBOOL, "error converting XML data '%s' to boolean\n", FIELD_S},
-        {CLI_STRTOD_ERRNO, "error converting XML data '%s' to number\n", FIELD_S},
-        {CLI_STRTOI_ERRNO, "error converting XML data '%s' to integer\n", FIELD_S},
-        {CLI_STRTONUM_EMPTY, "found no number in XML data '%s'\n", FIELD_S},
-        {CLI_STRTONUM_NOT, "found non-number characters in XML data '%s'\n", FIELD_S},
-        {CLI_STRTONUM_RANGE, "number in XML data '%s' out of range\n", FIELD_S},
+        {CLI_SERVE_INPUT, "unable to read whole request from input\n", FIELD_ZZZ},
+        {CLI_SERVE_MEMORY, "error allocating memory for request\n", FIELD_ZZZ},
+        {CLI_SERVE_REQUEST, "invalid request command -- '%c'\n", FIELD_C},
+        {CLI_SERVE_WRITE, "error writing reply to request\n", FIELD_ZZZ},
+        {CLI_STRTOBOOL, "error converting infoset data '%s' to boolean\n", FIELD_S},
+        {CLI_STRTONUM_EMPTY, "found no number in infoset data '%s'\n", FIELD_S},
+        {CLI_STRTONUM_NOT, "found non-number characters in infoset data '%s'\n", FIELD_S},
+        {CLI_STRTONUM_RANGE, "number in infoset data '%s' out of range\n", FIELD_S},
         {CLI_UNEXPECTED_ARGUMENT, "unexpected extra argument -- '%s'\n" USAGE, FIELD_S},
-        {CLI_XML_DECL, "error making new XML declaration\n", FIELD_ZZZ},
-        {CLI_XML_ELEMENT, "error making new XML element '%s'\n", FIELD_S},
-        {CLI_XML_ERD, "unexpected ERD typeCode %" PRId64 " while reading XML data\n", FIELD_D64},
         {CLI_XML_GONE, "ran out of XML data\n", FIELD_ZZZ},
         {CLI_XML_INPUT, "unable to read XML data from input file\n", FIELD_ZZZ},
         {CLI_XML_LEFT, "did not consume all of the XML data, '%s' left\n", FIELD_S},
+        {CLI_XML_LONG, "found XML name or text longer than %" PRId64 " characters\n", FIELD_D64},
         {CLI_XML_MISMATCH, "found mismatch between XML data and infoset '%s'\n", FIELD_S},
+        {CLI_XML_SYNTAX, "found unexpected character '%c' in XML data\n", FIELD_C},
         {CLI_XML_WRITE, "error writing XML document\n", FIELD_ZZZ},
     };
 
@@ -26,42 +26,71 @@
 
 enum CliCode
 {
-    CLI_FILE_CLOSE = ERR_ZZZ,
+    CLI_BENCH_INPUT = ERR_ZZZ,
+    CLI_BENCH_MEMORY,
+    CLI_BENCH_MISMATCH,
+    CLI_BENCH_ROUNDTRIP,
+    CLI_BINARY_GONE,
+    CLI_BINARY_HEADER,
+    CLI_BINARY_INPUT,
+    CLI_BINARY_LEFT,
+    CLI_BINARY_MISMATCH,
+    CLI_BINARY_WRITE,
+    CLI_COLUMN_LAYOUT,
+    CLI_COLUMN_MEMORY,
+    CLI_COLUMN_NAME,
+    CLI_COLUMN_WRITE,
+    CLI_FILE_CLOSE,
     CLI_FILE_OPEN,
     CLI_HELP_USAGE,
+    CLI_INFOSET_ERD,
+    CLI_INFOSET_UNPARSE,
     CLI_INVALID_COMMAND,
     CLI_INVALID_INFOSET,
+    CLI_INVALID_JOBS,
+    CLI_INVALID_LONG_OPTION,
     CLI_INVALID_OPTION,
+    CLI_INVALID_RUNS,
+    CLI_JSON_GONE,
+    CLI_JSON_INPUT,
+    CLI_JSON_LEFT,
+    CLI_JSON_MISMATCH,
+    CLI_JSON_SYNTAX,
+    CLI_JSON_WRITE,
+    CLI_LIBRARY_INFOSET,
+    CLI_LIBRARY_MEMORY,
     CLI_MISSING_COMMAND,
     CLI_MISSING_VALUE,
+    CLI_NEW_CONTEXT,
+    CLI_PARALLEL_MEMORY,
+    CLI_PARALLEL_THREAD,
     CLI_PROGRAM_ERROR,
     CLI_PROGRAM_VERSION,
-    CLI_STACK_EMPTY,
-    CLI_STACK_OVERFLOW,
-    CLI_STACK_UNDERFLOW,
+    CLI_SERVE_INPUT,
+    CLI_SERVE_MEMORY,
+    CLI_SERVE_REQUEST,
+    CLI_SERVE_WRITE,
     CLI_STRTOBOOL,
-    CLI_STRTOD_ERRNO,
-    CLI_STRTOI_ERRNO,
     CLI_STRTONUM_EMPTY,
     CLI_STRTONUM_NOT,
     CLI_STRTONUM_RANGE,
     CLI_UNEXPECTED_ARGUMENT,
-    CLI_XML_DECL,
-    CLI_XML_ELEMENT,
-    CLI_XML_ERD,
     CLI_XML_GONE,
     CLI_XML_INPUT,
     CLI_XML_LEFT,
+    CLI_XML_LONG,
     CLI_XML_MISMATCH,
+    CLI_XML_SYNTAX,
     CLI_XML_WRITE,
     CLI_ZZZ,
 };
 
-// CliLimits - limits on how many elements static arrays can hold
+// CliLimits - limits on how many threads and bytes parallel parsing can use
 
 enum CliLimits
 {
-    LIMIT_XML_NESTING = 100, // limits how deep infoset elements can nest
+    LIMIT_PARALLEL_CHUNK = 262144, // limits how many bytes each parallel job parses at once
+    LIMIT_PARSE_JOBS = 256,        // limits how many threads can parse records
 };
 
 #endif // CLI_ERRORS_H
@@ -0,0 +1,346 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "column_writer.h"
+#include <stdint.h>      // for uint16_t, uint32_t, uint64_t, uint8_t
+#include <stdio.h>       // for fwrite, snprintf
+#include <stdlib.h>      // for free, calloc, malloc, realloc
+#include <string.h>      // for memcpy
+#include "cli_errors.h"  // for CLI_COLUMN_LAYOUT, CLI_COLUMN_MEMORY, CLI_COLUMN_NAME, CLI_COLUMN_WRITE
+#include "errors.h"      // for Error
+// clang-format on
+
+// Write bytes to the stream followed by enough zeros to end on a
+// multiple of 8 bytes
+
+static const Error *
+columnWritePadded(ColumnWriter *writer, const void *bytes, size_t length)
+{
+    static const char zeros[8] = {0};
+    const size_t      padding = (8 - length % 8) % 8;
+    if (fwrite(bytes, 1, length, writer->stream) < length ||
+        fwrite(zeros, 1, padding, writer->stream) < padding)
+    {
+        static const Error error = {CLI_COLUMN_WRITE, {0}};
+        return &error;
+    }
+    return NULL;
+}
+
+// Write the complete rows in the columns as a batch and empty them
+
+static const Error *
+columnWriteBatch(ColumnWriter *writer)
+{
+    const uint64_t rows = writer->rows;
+    const Error *  error = columnWritePadded(writer, &rows, sizeof(rows));
+    size_t         i;
+    for (i = 0; i < writer->numColumns && !error; i++)
+    {
+        const Column *column = &writer->columns[i];
+        error = columnWritePadded(writer, column->values, writer->rows * column->size);
+    }
+    writer->rows = 0;
+    return error;
+}
+
+// Append bytes to the header being built during the first record
+
+static const Error *
+columnAppendHeader(ColumnWriter *writer, const void *bytes, size_t length)
+{
+    char *header = realloc(writer->header, writer->headerLength + length);
+    if (!header)
+    {
+        static const Error error = {CLI_COLUMN_MEMORY, {0}};
+        return &error;
+    }
+    memcpy(header + writer->headerLength, bytes, length);
+    writer->header = header;
+    writer->headerLength += length;
+    return NULL;
+}
+
+// Add a column for an element found in the first record, naming it
+// by the element's path (with its index if it's an array's item)
+
+static const Error *
+columnAdd(ColumnWriter *writer, const ERD *erd)
+{
+    // Count the array's items already added as columns
+    size_t index = 0;
+    while (index < writer->numColumns && writer->columns[writer->numColumns - index - 1].erd == erd)
+    {
+        index++;
+    }
+
+    char         name[LIMIT_NAME_LENGTH];
+    const size_t length = (size_t)snprintf(name, sizeof(name), "%.*s%s", (int)writer->pathLength,
+                                           writer->path, erd->namedQName.name);
+    size_t       nameLength = length;
+    if (erd->isArray && nameLength < sizeof(name))
+    {
+        nameLength += (size_t)snprintf(name + nameLength, sizeof(name) - nameLength, "[%zu]", index);
+    }
+    if (nameLength >= sizeof(name))
+    {
+        Error *error = &writer->context->error;
+        error->code = CLI_COLUMN_NAME;
+        error->arg.s = erd->namedQName.name;
+        return error;
+    }
+
+    Column *columns = realloc(writer->columns, (writer->numColumns + 1) * sizeof(Column));
+    if (!columns)
+    {
+        static const Error error = {CLI_COLUMN_MEMORY, {0}};
+        return &error;
+    }
+    writer->columns = columns;
+
+    Column *column = &columns[writer->numColumns];
+    column->erd = erd;
+    column->size = numberSize(erd->typeCode);
+    column->values = malloc(LIMIT_COLUMN_ROWS * column->size);
+    if (!column->values)
+    {
+        static const Error error = {CLI_COLUMN_MEMORY, {0}};
+        return &error;
+    }
+    writer->numColumns++;
+
+    const uint8_t  typeCode = (uint8_t)erd->typeCode;
+    const uint16_t nameLength16 = (uint16_t)nameLength;
+    const Error *  error = columnAppendHeader(writer, &typeCode, sizeof(typeCode));
+    if (!error)
+    {
+        error = columnAppendHeader(writer, &nameLength16, sizeof(nameLength16));
+    }
+    if (!error)
+    {
+        error = columnAppendHeader(writer, name, nameLength);
+    }
+    return error;
+}
+
+// Write the file's header once the first record has found all columns
+
+static const Error *
+columnWriteHeader(ColumnWriter *writer)
+{
+    const uint32_t version = COLUMN_VERSION;
+    const uint32_t count = (uint32_t)writer->numColumns;
+    char           start[12];
+    memcpy(start, COLUMN_MAGIC, 4);
+    memcpy(start + 4, &version, sizeof(version));
+    memcpy(start + 8, &count, sizeof(count));
+    if (fwrite(start, 1, sizeof(start), writer->stream) < sizeof(start))
+    {
+        static const Error error = {CLI_COLUMN_WRITE, {0}};
+        return &error;
+    }
+
+    // Pad the whole header, not just the column names, to 8 bytes
+    const size_t padding = (8 - (sizeof(start) + writer->headerLength) % 8) % 8;
+    const char   zeros[8] = {0};
+    const Error *error = columnAppendHeader(writer, zeros, padding);
+    if (!error && writer->headerLength &&
+        fwrite(writer->header, 1, writer->headerLength, writer->stream) < writer->headerLength)
+    {
+        static const Error error_write = {CLI_COLUMN_WRITE, {0}};
+        error = &error_write;
+    }
+    return error;
+}
+
+// Start a new row
+
+static const Error *
+columnStartDocument(ColumnWriter *writer)
+{
+    writer->column = 0;
+    writer->pathLength = 0;
+    return NULL;
+}
+
+// End the row and write a batch if the columns are full (writes the
+// file's header first after the first row)
+
+static const Error *
+columnEndDocument(ColumnWriter *writer)
+{
+    const Error *error = NULL;
+    if (!writer->learned)
+    {
+        writer->learned = true;
+        if (!writer->headed)
+        {
+            writer->headed = true;
+            error = columnWriteHeader(writer);
+        }
+        free(writer->header);
+        writer->header = NULL;
+        writer->headerLength = 0;
+    }
+    if (!error && writer->column != writer->numColumns)
+    {
+        Error *error_layout = &writer->context->error;
+        error_layout->code = CLI_COLUMN_LAYOUT;
+        error_layout->arg.s = "end of record";
+        return error_layout;
+    }
+    if (!error && ++writer->rows == LIMIT_COLUMN_ROWS)
+    {
+        error = columnWriteBatch(writer);
+    }
+    return error;
+}
+
+// Add a complex element's name to the path of its children
+
+static const Error *
+columnStartComplex(ColumnWriter *writer, const InfosetBase *base)
+{
+    const NamedQName *qname = &base->erd->namedQName;
+    if (writer->pathLength + qname->nameLength + 1 >= sizeof(writer->path))
+    {
+        Error *error = &writer->context->error;
+        error->code = CLI_COLUMN_NAME;
+        error->arg.s = qname->name;
+        return error;
+    }
+    memcpy(writer->path + writer->pathLength, qname->name, qname->nameLength);
+    writer->pathLength += qname->nameLength;
+    writer->path[writer->pathLength++] = '/';
+    return NULL;
+}
+
+// Remove a complex element's name from the path
+
+static const Error *
+columnEndComplex(ColumnWriter *writer, const InfosetBase *base)
+{
+    writer->pathLength -= base->erd->namedQName.nameLength + 1;
+    return NULL;
+}
+
+// Append a number to its column (adding the column if the first
+// record is still finding the columns)
+
+static const Error *
+columnNumberElem(ColumnWriter *writer, const ERD *erd, const void *number)
+{
+    if (!writer->learned && writer->column == writer->numColumns)
+    {
+        const Error *error = columnAdd(writer, erd);
+        if (error) return error;
+    }
+    if (writer->column >= writer->numColumns || writer->columns[writer->column].erd != erd)
+    {
+        Error *error = &writer->context->error;
+        error->code = CLI_COLUMN_LAYOUT;
+        error->arg.s = erd->namedQName.name;
+        return error;
+    }
+
+    Column *column = &writer->columns[writer->column++];
+    memcpy(column->values + writer->rows * column->size, number, column->size);
+    return NULL;
+}
+
+// Append a run of adjacent numbers of the same type to their columns
+
+static const Error *
+columnNumberRun(ColumnWriter *writer, const ERD *const *erds, const void *numbers, size_t count)
+{
+    const Error *error = NULL;
+    const size_t size = numberSize(erds[0]->typeCode);
+    size_t       i;
+    for (i = 0; i < count && !error; i++)
+    {
+        error = columnNumberElem(writer, erds[i], (const char *)numbers + i * size);
+    }
+    return error;
+}
+
+// flush_columns, free_columns - write any rows left in a ColumnWriter's
+// columns as a batch (keeping the columns for more rows) or free the
+// columns' storage (call after writing the last batch)
+
+const Error *
+flush_columns(ColumnWriter *writer)
+{
+    return writer->rows ? columnWriteBatch(writer) : NULL;
+}
+
+void
+free_columns(ColumnWriter *writer)
+{
+    size_t i;
+    for (i = 0; i < writer->numColumns; i++)
+    {
+        free(writer->columns[i].values);
+    }
+    free(writer->columns);
+    free(writer->header);
+    writer->columns = NULL;
+    writer->numColumns = 0;
+    writer->header = NULL;
+    writer->headerLength = 0;
+    writer->learned = false;
+    writer->rows = 0;
+}
+
+// copy_columns - give a new ColumnWriter the columns another writer
+// learned from its first record (but none of its rows) and leave out
+// the header, so every record the new writer visits must match the
+// other writer's header (free the columns with free_columns)
+
+const Error *
+copy_columns(ColumnWriter *writer, const ColumnWriter *learned)
+{
+    static const Error error = {CLI_COLUMN_MEMORY, {0}};
+
+    writer->headed = true;
+    writer->learned = true;
+    writer->columns = calloc(learned->numColumns ? learned->numColumns : 1, sizeof(Column));
+    if (!writer->columns)
+    {
+        return &error;
+    }
+    for (writer->numColumns = 0; writer->numColumns < learned->numColumns; writer->numColumns++)
+    {
+        Column *column = &writer->columns[writer->numColumns];
+        column->erd = learned->columns[writer->numColumns].erd;
+        column->size = learned->columns[writer->numColumns].size;
+        column->values = malloc(LIMIT_COLUMN_ROWS * column->size);
+        if (!column->values)
+        {
+            return &error;
+        }
+    }
+    return NULL;
+}
+
+// Initialize a struct with our visitor event handler methods
+
+const VisitEventHandler columnWriterMethods = {
+    (VisitStartDocument)&columnStartDocument, (VisitEndDocument)&columnEndDocument,
+    (VisitStartComplex)&columnStartComplex,   (VisitEndComplex)&columnEndComplex,
+    (VisitNumberElem)&columnNumberElem,       (VisitNumberRun)&columnNumberRun,
+};
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COLUMN_WRITER_H
+#define COLUMN_WRITER_H
+
+// clang-format off
+#include <stdbool.h>  // for bool
+#include <stddef.h>   // for size_t
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for Error, LIMIT_NAME_LENGTH
+#include "infoset.h"  // for VisitEventHandler, RuntimeContext, ERD
+// clang-format on
+
+// Columnar infoset format - a struct-of-arrays file for analytics which
+// holds many records' infosets with each primitive field's values
+// stored next to each other.  A file starts with the 4-byte magic
+// COLUMN_MAGIC, a 4-byte COLUMN_VERSION, and a 4-byte column count,
+// followed by each column's 1-byte typeCode, 2-byte name length, and
+// name (its element's path from the root, like "ex_nums/array/a[1]"),
+// padded with zeros to a multiple of 8 bytes.  Batches of rows then
+// follow, each starting with an 8-byte row count followed by each
+// column's values packed end to end (booleans take 1 byte each) and
+// padded with zeros to a multiple of 8 bytes, so every column starts
+// 8-byte aligned the way Arrow's fixed-width value buffers do.  All
+// numbers are in the writer's native byte order.
+
+#define COLUMN_MAGIC "DAFC"
+#define COLUMN_VERSION 1u
+
+// Limits on how many rows each batch can hold
+
+enum ColumnLimits
+{
+    LIMIT_COLUMN_ROWS = 65536, // limits how many rows each batch holds
+};
+
+// Column - storage for one primitive field's values in a batch
+
+typedef struct Column
+{
+    const ERD *erd;    // element whose values fill column
+    size_t     size;   // number of bytes in each value
+    char *     values; // storage for LIMIT_COLUMN_ROWS values
+} Column;
+
+// ColumnWriter - infoset visitor with methods to output the columnar
+// infoset format (appends each visited record's primitive fields to
+// its columns as a new row, learning the columns from the first
+// record and requiring every later record to visit the same elements,
+// and writes a batch to the stream whenever the columns fill up)
+
+typedef struct ColumnWriter
+{
+    const VisitEventHandler handler;
+    FILE *                  stream;
+    RuntimeContext *        context;
+    bool                    headed;                  // whether file's header is written (or left out)
+    bool                    learned;                 // whether first record has found all columns
+    Column *                columns;                 // columns found in first record
+    size_t                  numColumns;              // number of columns found in first record
+    size_t                  column;                  // next column to fill in current row
+    size_t                  rows;                    // number of complete rows in batch
+    char *                  header;                  // header being built during first record
+    size_t                  headerLength;            // number of bytes in header
+    size_t                  pathLength;              // length of path to current element
+    char                    path[LIMIT_NAME_LENGTH]; // path to current element
+} ColumnWriter;
+
+// ColumnWriter methods to pass to walkInfoset method
+
+extern const VisitEventHandler columnWriterMethods;
+
+// flush_columns, free_columns - write any rows left in a ColumnWriter's
+// columns as a batch (keeping the columns for more rows) or free the
+// columns' storage (call after writing the last batch)
+
+extern const Error *flush_columns(ColumnWriter *writer);
+extern void         free_columns(ColumnWriter *writer);
+
+// copy_columns - give a new ColumnWriter the columns another writer
+// learned from its first record (but none of its rows) and leave out
+// the header, so every record the new writer visits must match the
+// other writer's header (free the columns with free_columns)
+
+extern const Error *copy_columns(ColumnWriter *writer, const ColumnWriter *learned);
+
+#endif // COLUMN_WRITER_H
@@ -17,9 +17,12 @@
 
 // clang-format off
 #include "daffodil_getopt.h"
+#include <ctype.h>       // for isdigit
+#include <getopt.h>      // for getopt_long, option, no_argument, required_argument
+#include <stdlib.h>      // for strtoul
 #include <string.h>      // for strcmp, strrchr
-#include <unistd.h>      // for optarg, getopt, optopt, optind
-#include "cli_errors.h"  // for CLI_UNEXPECTED_ARGUMENT, CLI_HELP_USAGE, CLI_INVALID_COMMAND, CLI_INVALID_INFOSET, CLI_INVALID_OPTION, CLI_MISSING_COMMAND, CLI_MISSING_VALUE, CLI_PROGRAM_ERROR, CLI_PROGRAM_VERSION
+#include <unistd.h>      // for optarg, optopt, optind
+#include "cli_errors.h"  // for CLI_UNEXPECTED_ARGUMENT, CLI_HELP_USAGE, CLI_INVALID_COMMAND, CLI_INVALID_INFOSET, CLI_INVALID_JOBS, CLI_INVALID_LONG_OPTION, CLI_INVALID_OPTION, CLI_INVALID_RUNS, CLI_MISSING_COMMAND, CLI_MISSING_VALUE, CLI_PROGRAM_ERROR, CLI_PROGRAM_VERSION, LIMIT_PARSE_JOBS
 // clang-format on
 
 // Initialize our "daffodil" CLI options
@@ -28,12 +31,24 @@ struct daffodil_cli daffodil_cli = {
     DAFFODIL_MISSING_COMMAND, // default subcommand
 };
 
+// Initialize our "daffodil bench" CLI options
+
+struct daffodil_bench_cli daffodil_bench = {
+    "-", // default infile
+    "-", // default outfile
+    10,  // default runs
+};
+
 // Initialize our "daffodil parse" CLI options
 
 struct daffodil_parse_cli daffodil_parse = {
     "xml", // default infoset type
     "-",   // default infile
     "-",   // default outfile
+    false, // default mmap_infile
+    false, // default stream
+    false, // default timing
+    1,     // default jobs
 };
 
 // Initialize our "daffodil unparse" CLI options
@@ -42,6 +57,23 @@ struct daffodil_unparse_cli daffodil_unparse = {
     "xml", // default infoset type
     "-",   // default infile
     "-",   // default outfile
+    false, // default timing
+};
+
+// Define our long options (--stream has no short option, just like
+// the "daffodil" CLI of runtime1)
+
+static const struct option long_options[] = {
+    {"help", no_argument, NULL, 'h'},
+    {"infoset-type", required_argument, NULL, 'I'},
+    {"jobs", required_argument, NULL, 'j'},
+    {"mmap", no_argument, NULL, 'm'},
+    {"output", required_argument, NULL, 'o'},
+    {"runs", required_argument, NULL, 'r'},
+    {"stream", no_argument, NULL, 's'},
+    {"timing", no_argument, NULL, 't'},
+    {"version", no_argument, NULL, 'V'},
+    {NULL, 0, NULL, 0},
 };
 
 // Parse our command line interface.  Note there is NO portable way to
@@ -61,7 +93,7 @@ parse_daffodil_cli(int argc, char *argv[])
 
     // We expect callers to put all non-option arguments at the end
     int opt = 0;
-    while ((opt = getopt(argc, argv, ":hI:o:V")) != -1)
+    while ((opt = getopt_long(argc, argv, ":hI:j:mo:r:tV", long_options, NULL)) != -1)
     {
         switch (opt)
         {
@@ -70,7 +102,8 @@ parse_daffodil_cli(int argc, char *argv[])
             error.arg.s = exe;
             return &error;
         case 'I':
-            if (strcmp("xml", optarg) != 0)
+            if (strcmp("xml", optarg) != 0 && strcmp("json", optarg) != 0 && strcmp("binary", optarg) != 0 &&
+                strcmp("columns", optarg) != 0 && strcmp("null", optarg) != 0)
             {
                 error.code = CLI_INVALID_INFOSET;
                 error.arg.s = optarg;
@@ -79,10 +112,49 @@ parse_daffodil_cli(int argc, char *argv[])
             daffodil_parse.infoset_converter = optarg;
             daffodil_unparse.infoset_converter = optarg;
             break;
+        case 'j':
+        {
+            char *              endptr = NULL;
+            const unsigned long jobs = strtoul(optarg, &endptr, 10);
+            if (endptr == optarg || *endptr != '\0' || jobs < 1 || jobs > LIMIT_PARSE_JOBS)
+            {
+                error.code = CLI_INVALID_JOBS;
+                error.arg.s = optarg;
+                return &error;
+            }
+            daffodil_parse.jobs = jobs;
+            break;
+        }
+        case 'm':
+            daffodil_parse.mmap_infile = true;
+            break;
         case 'o':
+            daffodil_bench.outfile = optarg;
             daffodil_parse.outfile = optarg;
             daffodil_unparse.outfile = optarg;
             break;
+        case 'r':
+        {
+            char *              endptr = NULL;
+            const unsigned long runs = strtoul(optarg, &endptr, 10);
+            // Unlike -j, -r has no upper bound to catch strtoul negating
+            // "-1" into a huge count, so accept only digits
+            if (!isdigit((unsigned char)optarg[0]) || *endptr != '\0' || runs < 1)
+            {
+                error.code = CLI_INVALID_RUNS;
+                error.arg.s = optarg;
+                return &error;
+            }
+            daffodil_bench.runs = runs;
+            break;
+        }
+        case 's':
+            daffodil_parse.stream = true;
+            break;
+        case 't':
+            daffodil_parse.timing = true;
+            daffodil_unparse.timing = true;
+            break;
         case 'V':
             error.code = CLI_PROGRAM_VERSION;
             error.arg.s = daffodil_program_version;
@@ -92,8 +164,16 @@ parse_daffodil_cli(int argc, char *argv[])
             error.arg.c = optopt;
             return &error;
         case '?':
-            error.code = CLI_INVALID_OPTION;
-            error.arg.c = optopt;
+            if (optopt)
+            {
+                error.code = CLI_INVALID_OPTION;
+                error.arg.c = optopt;
+            }
+            else
+            {
+                error.code = CLI_INVALID_LONG_OPTION;
+                error.arg.s = argv[optind - 1];
+            }
             return &error;
         default:
             // shouldn't happen unless programmer made error
@@ -109,7 +189,20 @@ parse_daffodil_cli(int argc, char *argv[])
     {
         const char *arg = argv[i];
 
-        if (DAFFODIL_PARSE == daffodil_cli.subcommand)
+        if (DAFFODIL_BENCH == daffodil_cli.subcommand)
+        {
+            if (strcmp("-", daffodil_bench.infile) == 0)
+            {
+                daffodil_bench.infile = arg;
+            }
+            else
+            {
+                error.code = CLI_UNEXPECTED_ARGUMENT;
+                error.arg.s = arg;
+                return &error;
+            }
+        }
+        else if (DAFFODIL_PARSE == daffodil_cli.subcommand)
         {
             if (strcmp("-", daffodil_parse.infile) == 0)
             {
@@ -122,6 +215,12 @@ parse_daffodil_cli(int argc, char *argv[])
                 return &error;
             }
         }
+        else if (DAFFODIL_SERVE == daffodil_cli.subcommand)
+        {
+            error.code = CLI_UNEXPECTED_ARGUMENT;
+            error.arg.s = arg;
+            return &error;
+        }
         else if (DAFFODIL_UNPARSE == daffodil_cli.subcommand)
         {
             if (strcmp("-", daffodil_unparse.infile) == 0)
@@ -135,10 +234,18 @@ parse_daffodil_cli(int argc, char *argv[])
                 return &error;
             }
         }
+        else if (strcmp("bench", arg) == 0)
+        {
+            daffodil_cli.subcommand = DAFFODIL_BENCH;
+        }
         else if (strcmp("parse", arg) == 0)
         {
             daffodil_cli.subcommand = DAFFODIL_PARSE;
         }
+        else if (strcmp("serve", arg) == 0)
+        {
+            daffodil_cli.subcommand = DAFFODIL_SERVE;
+        }
         else if (strcmp("unparse", arg) == 0)
         {
             daffodil_cli.subcommand = DAFFODIL_UNPARSE;
@@ -19,7 +19,9 @@
 #define DAFFODIL_GETOPT_H
 
 // clang-format off
-#include "errors.h"  // for Error
+#include <stdbool.h>  // for bool
+#include <stddef.h>   // for size_t
+#include "errors.h"   // for Error
 // clang-format on
 
 // Declare our "daffodil" CLI options
@@ -29,11 +31,22 @@ extern struct daffodil_cli
     enum daffodil_subcommand
     {
         DAFFODIL_MISSING_COMMAND,
+        DAFFODIL_BENCH,
         DAFFODIL_PARSE,
+        DAFFODIL_SERVE,
         DAFFODIL_UNPARSE
     } subcommand;
 } daffodil_cli;
 
+// Declare our "daffodil bench" CLI options
+
+extern struct daffodil_bench_cli
+{
+    const char *infile;
+    const char *outfile;
+    size_t      runs;
+} daffodil_bench;
+
 // Declare our "daffodil parse" CLI options
 
 extern struct daffodil_parse_cli
@@ -41,6 +54,10 @@ extern struct daffodil_parse_cli
     const char *infoset_converter;
     const char *infile;
     const char *outfile;
+    bool        mmap_infile;
+    bool        stream;
+    bool        timing;
+    size_t      jobs;
 } daffodil_parse;
 
 // Declare our "daffodil unparse" CLI options
@@ -50,6 +67,7 @@ extern struct daffodil_unparse_cli
     const char *infoset_converter;
     const char *infile;
     const char *outfile;
+    bool        timing;
 } daffodil_unparse;
 
 // Parse our command line interface
@@ -0,0 +1,205 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file is compiled only into the shared library which
+// CodeGenerator.compileLibrary builds with -DDAFFODIL_JNI (which needs
+// the JDK's jni.h); it implements the native methods of the JVM's
+// org.apache.daffodil.runtime2.Runtime2Library class
+
+#ifdef DAFFODIL_JNI
+
+// clang-format off
+#include <dlfcn.h>        // for dlclose, dlopen, dlsym, RTLD_LOCAL, RTLD_NOW
+#include <jni.h>          // for JNIEnv, jobject, jstring, jlong, jint, jlongArray, JNIEXPORT, JNICALL
+#include <stdbool.h>      // for bool, false, true
+#include <stddef.h>       // for size_t, NULL
+#include <stdint.h>       // for intptr_t
+#include <stdlib.h>       // for calloc, free
+#include <string.h>       // for memcpy, strlen
+#include "errors.h"       // for UNUSED
+#include "infoset.h"      // for RuntimeContext
+#include "library_api.h"  // for daffodil_new_context, daffodil_free_context, daffodil_parse_buffer, daffodil_unparse_buffer, LIBRARY_ERROR
+// clang-format on
+
+// Library - the entry points of one schema's shared library, found by
+// path so each Runtime2Library calls its own schema's code no matter
+// which library's copy of these native methods the JVM linked to
+
+typedef struct Library
+{
+    void *handle;
+    RuntimeContext *(*new_context)(void);
+    void (*free_context)(RuntimeContext *context);
+    int (*parse_buffer)(RuntimeContext *context, const char *infoset_type, const void *input,
+                        size_t input_length, void *output, size_t output_capacity, size_t *output_length,
+                        char *messages, size_t messages_capacity);
+    int (*unparse_buffer)(RuntimeContext *context, const char *infoset_type, const void *input,
+                          size_t input_length, void *output, size_t output_capacity, size_t *output_length,
+                          char *messages, size_t messages_capacity);
+} Library;
+
+// Get a Library from its handle on the JVM side
+
+static Library *
+library_of(jlong library)
+{
+    return (Library *)(intptr_t)library;
+}
+
+// openLibrary - open a schema's shared library and find its entry
+// points, returning 0 if it can't
+
+JNIEXPORT jlong JNICALL
+Java_org_apache_daffodil_runtime2_Runtime2Library_openLibrary(JNIEnv *env, jobject self, jstring path)
+{
+    UNUSED(self);
+    const char *pathname = (*env)->GetStringUTFChars(env, path, NULL);
+    if (!pathname)
+    {
+        return 0;
+    }
+    void *handle = dlopen(pathname, RTLD_NOW | RTLD_LOCAL);
+    (*env)->ReleaseStringUTFChars(env, path, pathname);
+    if (!handle)
+    {
+        return 0;
+    }
+
+    // Converting dlsym's results to function pointers is a POSIX
+    // extension which -pedantic warns about, so copy them instead
+    Library *lib = calloc(1, sizeof(Library));
+    void *   symbols[4] = {dlsym(handle, "daffodil_new_context"), dlsym(handle, "daffodil_free_context"),
+                        dlsym(handle, "daffodil_parse_buffer"), dlsym(handle, "daffodil_unparse_buffer")};
+    if (!lib || !symbols[0] || !symbols[1] || !symbols[2] || !symbols[3])
+    {
+        free(lib);
+        dlclose(handle);
+        return 0;
+    }
+    lib->handle = handle;
+    memcpy(&lib->new_context, &symbols[0], sizeof(void *));
+    memcpy(&lib->free_context, &symbols[1], sizeof(void *));
+    memcpy(&lib->parse_buffer, &symbols[2], sizeof(void *));
+    memcpy(&lib->unparse_buffer, &symbols[3], sizeof(void *));
+    return (jlong)(intptr_t)lib;
+}
+
+// closeLibrary - close a schema's shared library
+
+JNIEXPORT void JNICALL
+Java_org_apache_daffodil_runtime2_Runtime2Library_closeLibrary(JNIEnv *env, jobject self, jlong library)
+{
+    UNUSED(env);
+    UNUSED(self);
+    Library *lib = library_of(library);
+    if (lib)
+    {
+        dlclose(lib->handle);
+        free(lib);
+    }
+}
+
+// newContext, freeContext - allocate or free a runtime context (give
+// each thread its own)
+
+JNIEXPORT jlong JNICALL
+Java_org_apache_daffodil_runtime2_Runtime2Library_newContext(JNIEnv *env, jobject self, jlong library)
+{
+    UNUSED(env);
+    UNUSED(self);
+    return (jlong)(intptr_t)library_of(library)->new_context();
+}
+
+JNIEXPORT void JNICALL
+Java_org_apache_daffodil_runtime2_Runtime2Library_freeContext(JNIEnv *env, jobject self, jlong library,
+                                                              jlong context)
+{
+    UNUSED(env);
+    UNUSED(self);
+    library_of(library)->free_context((RuntimeContext *)(intptr_t)context);
+}
+
+// Call a parse or unparse entry point with direct buffers' memory,
+// storing the output's and messages' lengths into lengths[0] and
+// lengths[1] (the messages are NUL-terminated)
+
+static jint
+call_buffers(JNIEnv *env, bool parse, jlong library, jlong context, jstring infosetType, jobject input,
+             jint inputLength, jobject output, jobject messages, jlongArray lengths)
+{
+    Library *   lib = library_of(library);
+    void *      inputData = (*env)->GetDirectBufferAddress(env, input);
+    void *      outputData = (*env)->GetDirectBufferAddress(env, output);
+    char *      messageData = (*env)->GetDirectBufferAddress(env, messages);
+    const jlong outputCapacity = (*env)->GetDirectBufferCapacity(env, output);
+    const jlong messageCapacity = (*env)->GetDirectBufferCapacity(env, messages);
+    if (!inputData || !outputData || !messageData || inputLength < 0 ||
+        inputLength > (*env)->GetDirectBufferCapacity(env, input))
+    {
+        return LIBRARY_ERROR;
+    }
+    const char *infoset_type = (*env)->GetStringUTFChars(env, infosetType, NULL);
+    if (!infoset_type)
+    {
+        return LIBRARY_ERROR;
+    }
+
+    size_t    outputLength = 0;
+    const int status = (parse ? lib->parse_buffer : lib->unparse_buffer)(
+        (RuntimeContext *)(intptr_t)context, infoset_type, inputData, (size_t)inputLength, outputData,
+        (size_t)outputCapacity, &outputLength, messageData, (size_t)messageCapacity);
+    (*env)->ReleaseStringUTFChars(env, infosetType, infoset_type);
+
+    const jlong counts[2] = {(jlong)outputLength, (jlong)strlen(messageData)};
+    (*env)->SetLongArrayRegion(env, lengths, 0, 2, counts);
+    return status;
+}
+
+// parseBuffer, unparseBuffer - parse or unparse inputLength bytes of a
+// direct input buffer into direct output and messages buffers,
+// returning a LibraryStatus
+
+JNIEXPORT jint JNICALL
+Java_org_apache_daffodil_runtime2_Runtime2Library_parseBuffer(JNIEnv *env, jobject self, jlong library,
+                                                              jlong context, jstring infosetType,
+                                                              jobject input, jint inputLength, jobject output,
+                                                              jobject messages, jlongArray lengths)
+{
+    UNUSED(self);
+    return call_buffers(env, true, library, context, infosetType, input, inputLength, output, messages,
+                        lengths);
+}
+
+JNIEXPORT jint JNICALL
+Java_org_apache_daffodil_runtime2_Runtime2Library_unparseBuffer(JNIEnv *env, jobject self, jlong library,
+                                                                jlong context, jstring infosetType,
+                                                                jobject input, jint inputLength,
+                                                                jobject output, jobject messages,
+                                                                jlongArray lengths)
+{
+    UNUSED(self);
+    return call_buffers(env, false, library, context, infosetType, input, inputLength, output, messages,
+                        lengths);
+}
+
+#else
+
+// ISO C forbids an empty translation unit
+
+typedef int daffodil_jni_unused;
+
+#endif // DAFFODIL_JNI
@@ -16,12 +16,28 @@
  */
 
 // clang-format off
-#include <stdio.h>            // for NULL, FILE, perror, fclose, fopen, stdin, stdout
+#include <inttypes.h>         // for PRIx64
+#include <stdint.h>           // for uint64_t
+#include <stdio.h>            // for NULL, FILE, perror, fclose, fopen, fputc, fprintf, stderr, stdin, stdout, fileno
 #include <string.h>           // for strcmp
-#include "cli_errors.h"       // for CLI_FILE_CLOSE, CLI_FILE_OPEN
-#include "daffodil_getopt.h"  // for daffodil_cli, parse_daffodil_cli, daffodil_parse, daffodil_parse_cli, daffodil_unparse, daffodil_unparse_cli, DAFFODIL_PARSE, DAFFODIL_UNPARSE
+#include <sys/mman.h>         // for madvise, mmap, munmap, MADV_SEQUENTIAL, MAP_FAILED, MAP_PRIVATE, PROT_READ
+#include <sys/stat.h>         // for fstat, stat, S_ISREG
+#include <time.h>             // for clock_gettime, timespec, CLOCK_MONOTONIC
+#include "bench_phases.h"     // for bench_phases
+#include "binary_reader.h"    // for binaryReaderMethods, BinaryReader
+#include "binary_writer.h"    // for binaryWriterMethods, BinaryWriter
+#include "cli_errors.h"       // for CLI_INFOSET_UNPARSE, CLI_FILE_CLOSE, CLI_FILE_OPEN, CLI_NEW_CONTEXT
+#include "column_writer.h"    // for columnWriterMethods, flush_columns, free_columns, ColumnWriter
+#include "daffodil_getopt.h"  // for daffodil_cli, parse_daffodil_cli, daffodil_bench, daffodil_bench_cli, daffodil_parse, daffodil_parse_cli, daffodil_unparse, daffodil_unparse_cli, DAFFODIL_BENCH, DAFFODIL_PARSE, DAFFODIL_SERVE, DAFFODIL_UNPARSE
 #include "errors.h"           // for continue_or_exit, print_diagnostics, Error
-#include "infoset.h"          // for walkInfoset, InfosetBase, PState, UState, rootElement, ERD, VisitEventHandler
+#include "infoset.h"          // for walkInfoset, InfosetBase, PState, UState, RuntimeContext, new_context, free_context, rootElementFixedLength, ERD, VisitEventHandler
+#include "json_reader.h"      // for jsonReaderMethods, JSONReader
+#include "json_writer.h"      // for jsonWriterMethods, JSONWriter
+#include "null_writer.h"      // for nullWriterMethods, NullWriter
+#include "parallel_parse.h"   // for parallel_parse
+#include "parsers.h"          // for parse_has_more_data, refill_from_memory, refill_from_stream
+#include "serve_requests.h"   // for serve_requests
+#include "unparsers.h"        // for flush_to_stream
 #include "xml_reader.h"       // for xmlReaderMethods, XMLReader
 #include "xml_writer.h"       // for xmlWriterMethods, XMLWriter
 // clang-format on
@@ -57,6 +73,60 @@ fclose_or_exit(FILE *stream, FILE *stdin_or_stdout)
     }
 }
 
+// Allocate a runtime context or exit if it can't be allocated
+
+static RuntimeContext *
+new_context_or_exit(void)
+{
+    RuntimeContext *context = new_context();
+    if (!context)
+    {
+        perror("calloc");
+        const Error error = {CLI_NEW_CONTEXT, {0}};
+        continue_or_exit(&error);
+    }
+    return context;
+}
+
+// Map a regular file into memory or return NULL if it can't be mapped
+// (stdin and pipes can't be mapped, so caller must read them instead)
+
+static const char *
+mmap_or_null(FILE *stream, size_t *length)
+{
+    struct stat st;
+    if (fstat(fileno(stream), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+    {
+        return NULL;
+    }
+
+    void *addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(stream), 0);
+    if (addr == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // Tell the kernel we will read the file only once from start to end
+    madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+    *length = (size_t)st.st_size;
+    return addr;
+}
+
+// Report how many bytes and records a command processed per second
+// since it started
+
+static void
+report_timing(const char *command, const struct timespec *start, size_t bytes, size_t records)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double seconds = (double)(end.tv_sec - start->tv_sec) +
+                           (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+    const double rate = seconds > 0 ? 1 / seconds : 0;
+    fprintf(stderr, "%s: %zu bytes, %zu records in %.6f s (%.0f bytes/s, %.0f records/s)\n", command, bytes,
+            records, seconds, (double)bytes * rate, (double)records * rate);
+}
+
 // Define our main entry point
 
 int
@@ -67,49 +137,211 @@ main(int argc, char *argv[])
     continue_or_exit(error);
 
     // Get our infoset ready
-    FILE *       input = stdin;
-    FILE *       output = stdout;
-    InfosetBase *root = rootElement();
+    FILE *          input = stdin;
+    FILE *          output = stdout;
+    RuntimeContext *context = new_context_or_exit();
+    InfosetBase *   root = context->root;
 
     // Perform our command
-    if (daffodil_cli.subcommand == DAFFODIL_PARSE)
+    if (daffodil_cli.subcommand == DAFFODIL_BENCH)
+    {
+        // Open our input and output files if given as arguments
+        input = fopen_or_exit(input, daffodil_bench.infile, "r");
+        output = fopen_or_exit(output, daffodil_bench.outfile, "w");
+
+        // Time each phase on every record of the input file
+        error = bench_phases(input, output, daffodil_bench.runs);
+        continue_or_exit(error);
+    }
+    else if (daffodil_cli.subcommand == DAFFODIL_PARSE)
     {
         // Open our input and output files if given as arguments
         input = fopen_or_exit(input, daffodil_parse.infile, "r");
         output = fopen_or_exit(output, daffodil_parse.outfile, "w");
 
-        // Parse the input file into our infoset
-        PState pstate = {input, 0, NULL, NULL};
-        root->erd->parseSelf(root, &pstate);
-        print_diagnostics(pstate.diagnostics);
-        continue_or_exit(pstate.error);
+        // Parse the input file into our infoset (straight from the
+        // input file's mapped pages if we can map it into memory)
+        const bool  parallel = daffodil_parse.stream && daffodil_parse.jobs > 1 && rootElementFixedLength;
+        PState      pstate = {input, 0, NULL, NULL, context, NULL, NULL, &refill_from_stream, {0}};
+        size_t      length = 0;
+        const char *mapped = daffodil_parse.mmap_infile || parallel ? mmap_or_null(input, &length) : NULL;
+        if (mapped)
+        {
+            pstate.next = mapped;
+            pstate.limit = mapped + length;
+            pstate.refill = &refill_from_memory;
+        }
+        XMLWriter                xmlWriter = {xmlWriterMethods, output, context, NULL, {0}};
+        JSONWriter               jsonWriter = {jsonWriterMethods, output, context, NULL, 0, NULL, {0}};
+        BinaryWriter             binaryWriter = {binaryWriterMethods, output, context, NULL, {0}};
+        ColumnWriter             columnWriter = {columnWriterMethods, output, context, false, false, NULL,
+                                                 0, 0, 0, NULL, 0, 0, {0}};
+        NullWriter               nullWriter = {nullWriterMethods, 0, 0};
+        const VisitEventHandler *writer = (VisitEventHandler *)&xmlWriter;
+        const bool               columns = strcmp(daffodil_parse.infoset_converter, "columns") == 0;
+        if (strcmp(daffodil_parse.infoset_converter, "json") == 0)
+        {
+            writer = (VisitEventHandler *)&jsonWriter;
+        }
+        else if (strcmp(daffodil_parse.infoset_converter, "binary") == 0)
+        {
+            writer = (VisitEventHandler *)&binaryWriter;
+        }
+        else if (columns)
+        {
+            writer = (VisitEventHandler *)&columnWriter;
+        }
+        else if (strcmp(daffodil_parse.infoset_converter, "null") == 0)
+        {
+            writer = (VisitEventHandler *)&nullWriter;
+        }
+        const bool      separate = !columns && writer != (VisitEventHandler *)&nullWriter;
+        struct timespec start;
+        size_t          bytes = 0;
+        size_t          records = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        do
+        {
+            // Separate each infoset after the first by a NUL character
+            // (except for columns, which hold every infoset as a row, and
+            // null, which writes only a checksum)
+            if (pstate.position)
+            {
+                if (separate)
+                {
+                    fputc('\0', output);
+                }
+                root->erd->initSelf(root);
+                pstate.position = 0;
+            }
+            root->erd->parseSelf(root, &pstate);
+            print_diagnostics(pstate.diagnostics);
+            if (pstate.diagnostics)
+            {
+                pstate.diagnostics->length = 0;
+                pstate.diagnostics = NULL;
+            }
+            if (pstate.error && columns)
+            {
+                flush_columns(&columnWriter);
+            }
+            continue_or_exit(pstate.error);
+            bytes += pstate.position;
+            records++;
+
+            // Visit the infoset and print XML, JSON, binary, or column data
+            // from it
+            error = walkInfoset(writer, context);
+            if (error && columns)
+            {
+                flush_columns(&columnWriter);
+            }
+            continue_or_exit(error);
 
-        // Visit the infoset and print XML from it
-        XMLWriter xmlWriter = {xmlWriterMethods, output, {NULL, NULL, 0}};
-        error = walkInfoset((VisitEventHandler *)&xmlWriter, root);
+            // Parse the remaining complete records on a pool of threads
+            // if every record has the same length as the first one
+            if (parallel && mapped && pstate.position)
+            {
+                // Write the rows parsed so far before the threads' rows
+                if (columns)
+                {
+                    error = flush_columns(&columnWriter);
+                    continue_or_exit(error);
+                }
+                const size_t rest = (size_t)(pstate.limit - pstate.next) / pstate.position;
+                error = parallel_parse(&pstate, pstate.position, output, daffodil_parse.jobs,
+                                       daffodil_parse.infoset_converter, &columnWriter, &nullWriter.checksum);
+                continue_or_exit(error);
+                bytes += rest * pstate.position;
+                records += rest;
+            }
+
+            // Parse again if asked to stream and data remains (stopping
+            // if the last parse made no progress)
+        } while (daffodil_parse.stream && pstate.position && parse_has_more_data(&pstate));
+        if (columns)
+        {
+            error = flush_columns(&columnWriter);
+            free_columns(&columnWriter);
+            continue_or_exit(error);
+        }
+        if (writer == (VisitEventHandler *)&nullWriter)
+        {
+            fprintf(output, "%016" PRIx64 "\n", nullWriter.checksum);
+        }
+        if (daffodil_parse.timing)
+        {
+            report_timing("parse", &start, bytes, records);
+        }
+        continue_or_exit(pstate.error);
+        if (mapped)
+        {
+            munmap((void *)mapped, length);
+        }
+    }
+    else if (daffodil_cli.subcommand == DAFFODIL_SERVE)
+    {
+        // Carry out requests until the process which started us closes
+        // our stdin
+        error = serve_requests(context, input, output);
         continue_or_exit(error);
     }
     else if (daffodil_cli.subcommand == DAFFODIL_UNPARSE)
     {
+        // Columns and null keep only the parsed values or their
+        // checksum, not enough to unparse
+        if (strcmp(daffodil_unparse.infoset_converter, "columns") == 0 ||
+            strcmp(daffodil_unparse.infoset_converter, "null") == 0)
+        {
+            Error error_unparse = {CLI_INFOSET_UNPARSE, {0}};
+            error_unparse.arg.s = daffodil_unparse.infoset_converter;
+            continue_or_exit(&error_unparse);
+        }
+
         // Open our input and output files if given as arguments
         input = fopen_or_exit(input, daffodil_unparse.infile, "r");
         output = fopen_or_exit(output, daffodil_unparse.outfile, "w");
 
-        // Initialize our infoset's values from the XML data
-        XMLReader xmlReader = {xmlReaderMethods, input, root, NULL, NULL};
-        error = walkInfoset((VisitEventHandler *)&xmlReader, root);
+        // Initialize our infoset's values from the XML, JSON, or binary data
+        // (reading all of it, since unparsing starts only after the walk)
+        XMLReader                xmlReader = {xmlReaderMethods, input, context, NULL, NULL, false, 0, 0,
+                                              {0}, {0}, {0}};
+        JSONReader               jsonReader = {jsonReaderMethods, input, context, NULL, NULL, NULL, {0}, {0}};
+        BinaryReader             binaryReader = {binaryReaderMethods, input, context, NULL, NULL, {0}};
+        const VisitEventHandler *reader = (VisitEventHandler *)&xmlReader;
+        if (strcmp(daffodil_unparse.infoset_converter, "json") == 0)
+        {
+            reader = (VisitEventHandler *)&jsonReader;
+        }
+        else if (strcmp(daffodil_unparse.infoset_converter, "binary") == 0)
+        {
+            reader = (VisitEventHandler *)&binaryReader;
+        }
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        error = walkInfoset(reader, context);
         continue_or_exit(error);
 
-        // Unparse our infoset to the output file
-        UState ustate = {output, 0, NULL, NULL};
+        // Unparse our infoset to the output buffer and flush it to
+        // the output file
+        UState ustate = {output, 0, NULL, NULL, context, NULL, NULL, &flush_to_stream, {0}};
         root->erd->unparseSelf(root, &ustate);
+        if (!ustate.error)
+        {
+            ustate.error = ustate.flush(&ustate);
+        }
         print_diagnostics(ustate.diagnostics);
         continue_or_exit(ustate.error);
+        if (daffodil_unparse.timing)
+        {
+            report_timing("unparse", &start, ustate.position, 1);
+        }
     }
 
     // Close our input and out files if we opened them
     fclose_or_exit(input, stdin);
     fclose_or_exit(output, stdout);
+    free_context(context);
 
     return 0;
 }
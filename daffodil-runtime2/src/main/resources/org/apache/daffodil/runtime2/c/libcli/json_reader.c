@@ -0,0 +1,347 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "json_reader.h"
+#include <stdbool.h>      // for bool, false, true
+#include <stdio.h>        // for fread, feof, ferror, EOF
+#include <string.h>       // for memcmp, memmove, strlen
+#include "cli_errors.h"   // for CLI_JSON_GONE, CLI_JSON_INPUT, CLI_JSON_LEFT, CLI_JSON_MISMATCH, CLI_JSON_SYNTAX
+#include "errors.h"       // for Error, LIMIT_NAME_LENGTH
+#include "number_text.h"  // for parse_number, number_error, NumberParse
+// clang-format on
+
+// Refill the input buffer once it has no unread bytes left (leaves it
+// empty if the stream has no more bytes)
+
+static const Error *
+jsonFill(JSONReader *reader)
+{
+    if (reader->next < reader->limit)
+    {
+        return NULL;
+    }
+
+    reader->next = reader->block;
+    reader->limit = reader->block;
+    while (reader->limit == reader->block && !feof(reader->stream))
+    {
+        const size_t count = fread(reader->block, 1, sizeof(reader->block), reader->stream);
+        reader->limit += count;
+        if (ferror(reader->stream))
+        {
+            static const Error error = {CLI_JSON_INPUT, {0}};
+            return &error;
+        }
+    }
+    return NULL;
+}
+
+// Peek at the next unread byte without consuming it (returns EOF if
+// the stream has no more bytes)
+
+static int
+jsonPeek(JSONReader *reader, const Error **errorptr)
+{
+    if (reader->next == reader->limit)
+    {
+        *errorptr = jsonFill(reader);
+        if (*errorptr || reader->next == reader->limit)
+        {
+            return EOF;
+        }
+    }
+    return (unsigned char)*reader->next;
+}
+
+// Skip JSON whitespace, then peek at the next unread byte
+
+static int
+jsonPeekToken(JSONReader *reader, const Error **errorptr)
+{
+    int c = jsonPeek(reader, errorptr);
+    while (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+    {
+        reader->next++;
+        c = jsonPeek(reader, errorptr);
+    }
+    return c;
+}
+
+// Report a byte which isn't the JSON syntax we expected
+
+static const Error *
+jsonUnexpected(JSONReader *reader, int c)
+{
+    if (c == EOF)
+    {
+        static const Error error_gone = {CLI_JSON_GONE, {0}};
+        return &error_gone;
+    }
+    Error *error = &reader->context->error;
+    error->code = CLI_JSON_SYNTAX;
+    error->arg.c = (char)c;
+    return error;
+}
+
+// Consume the given structural character after any whitespace
+
+static const Error *
+jsonExpect(JSONReader *reader, char expected)
+{
+    const Error *error = NULL;
+    const int    c = jsonPeekToken(reader, &error);
+    if (error) return error;
+    if (c != expected)
+    {
+        return jsonUnexpected(reader, c);
+    }
+    reader->next++;
+    return NULL;
+}
+
+// Consume a string's characters or a bare number's or literal's
+// characters and copy them into the reader's text buffer, returning
+// how many characters it copied (replaces each escape sequence
+// standing for a single ASCII character with that character)
+
+static const Error *
+jsonReadText(JSONReader *reader, size_t *length)
+{
+    const Error *error = NULL;
+    int          c = jsonPeekToken(reader, &error);
+    const bool   quoted = c == '"';
+    if (quoted)
+    {
+        reader->next++;
+        c = jsonPeek(reader, &error);
+    }
+
+    *length = 0;
+    while (!error && c != EOF)
+    {
+        if (quoted ? c == '"'
+                   : c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\n' || c == '\r')
+        {
+            break;
+        }
+        if (*length + 1 >= sizeof(reader->text))
+        {
+            static const Error error_input = {CLI_JSON_INPUT, {0}};
+            return &error_input;
+        }
+        if (quoted && c == '\\')
+        {
+            reader->next++;
+            c = jsonPeek(reader, &error);
+            switch (c)
+            {
+            case '"':
+            case '\\':
+            case '/':
+                break;
+            case 'b':
+                c = '\b';
+                break;
+            case 'f':
+                c = '\f';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            case 'r':
+                c = '\r';
+                break;
+            case 't':
+                c = '\t';
+                break;
+            default:
+                return error ? error : jsonUnexpected(reader, c);
+            }
+        }
+        reader->text[(*length)++] = (char)c;
+        reader->next++;
+        c = jsonPeek(reader, &error);
+    }
+    reader->text[*length] = 0;
+    if (error) return error;
+
+    if (quoted)
+    {
+        if (c != '"')
+        {
+            return jsonUnexpected(reader, c);
+        }
+        reader->next++;
+    }
+    else if (*length == 0)
+    {
+        return jsonUnexpected(reader, c);
+    }
+    return NULL;
+}
+
+// Report a mismatch between the JSON data and the expected element
+
+static const Error *
+jsonMismatch(JSONReader *reader, const ERD *erd)
+{
+    Error *error = &reader->context->error;
+    error->code = CLI_JSON_MISMATCH;
+    error->arg.s = erd->namedQName.name;
+    return error;
+}
+
+// Consume the end of the array of the previous sibling's items if it
+// was an array element which the next element doesn't continue
+
+static const Error *
+jsonCloseArray(JSONReader *reader, const ERD *next)
+{
+    if (reader->last && reader->last->isArray && reader->last != next)
+    {
+        return jsonExpect(reader, ']');
+    }
+    return NULL;
+}
+
+// Start reading an element: consume the comma separating it from its
+// previous sibling, then its member name (and the start of an array
+// for its items if it starts an array element) unless it continues
+// the array of its sibling
+
+static const Error *
+jsonStartElement(JSONReader *reader, const ERD *erd)
+{
+    const bool   continues = erd->isArray && reader->last == erd;
+    const Error *error = jsonCloseArray(reader, erd);
+    if (!error && reader->last)
+    {
+        error = jsonExpect(reader, ',');
+    }
+    if (!error && !continues)
+    {
+        size_t length = 0;
+        error = jsonReadText(reader, &length);
+        if (!error)
+        {
+            const char *local = erd->namedQName.local;
+            if (length != strlen(local) || memcmp(reader->text, local, length) != 0)
+            {
+                error = jsonMismatch(reader, erd);
+            }
+        }
+        if (!error)
+        {
+            error = jsonExpect(reader, ':');
+        }
+        if (!error && erd->isArray)
+        {
+            error = jsonExpect(reader, '[');
+        }
+    }
+    return error;
+}
+
+// Start reading JSON data from the stream
+
+static const Error *
+jsonStartDocument(JSONReader *reader)
+{
+    reader->next = reader->block;
+    reader->limit = reader->block;
+    reader->last = NULL;
+    return jsonExpect(reader, '{');
+}
+
+// Check that we have consumed all of the JSON data
+
+static const Error *
+jsonEndDocument(JSONReader *reader)
+{
+    const Error *error = jsonCloseArray(reader, NULL);
+    if (!error)
+    {
+        error = jsonExpect(reader, '}');
+    }
+    if (!error && jsonPeekToken(reader, &error) != EOF && !error)
+    {
+        static const Error error_left = {CLI_JSON_LEFT, {0}};
+        return &error_left;
+    }
+    return error;
+}
+
+// Consume a complex element's member name and the start of its object
+
+static const Error *
+jsonStartComplex(JSONReader *reader, const InfosetBase *base)
+{
+    const Error *error = jsonStartElement(reader, base->erd);
+    if (!error)
+    {
+        error = jsonExpect(reader, '{');
+    }
+    reader->last = NULL;
+    return error;
+}
+
+// Consume the end of a complex element's object
+
+static const Error *
+jsonEndComplex(JSONReader *reader, const InfosetBase *base)
+{
+    const Error *error = jsonCloseArray(reader, NULL);
+    if (!error)
+    {
+        error = jsonExpect(reader, '}');
+    }
+    reader->last = base->erd;
+    return error;
+}
+
+// Read a boolean, 32-bit or 64-bit real number, or 8, 16, 32, or
+// 64-bit signed or unsigned integer from a JSON member's value (which
+// may be a string like runtime1 writes or a bare number or literal)
+
+static const Error *
+jsonNumberElem(JSONReader *reader, const ERD *erd, void *number)
+{
+    size_t       length = 0;
+    const Error *error = jsonStartElement(reader, erd);
+    if (!error)
+    {
+        error = jsonReadText(reader, &length);
+    }
+    reader->last = erd;
+    if (error)
+    {
+        return error;
+    }
+
+    // Convert the text to the element's boolean or number type
+    const NumberParse result = parse_number(erd->typeCode, reader->text, number);
+    return number_error(result, erd->typeCode, reader->text, &reader->context->error);
+}
+
+// Initialize a struct with our visitor event handler methods
+
+const VisitEventHandler jsonReaderMethods = {
+    (VisitStartDocument)&jsonStartDocument, (VisitEndDocument)&jsonEndDocument,
+    (VisitStartComplex)&jsonStartComplex,   (VisitEndComplex)&jsonEndComplex,
+    (VisitNumberElem)&jsonNumberElem,       NULL,
+};
@@ -0,0 +1,49 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+// clang-format off
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for LIMIT_BLOCK_SIZE, LIMIT_NAME_LENGTH
+#include "infoset.h"  // for VisitEventHandler, RuntimeContext, ERD
+// clang-format on
+
+// JSONReader - infoset visitor with methods to read JSON written the
+// way runtime1's JsonInfosetOutputter writes it (reads JSON from the
+// stream into its input buffer only as it visits the infoset and
+// consumes each member on demand, expecting members in schema order
+// without building a document tree)
+
+typedef struct JSONReader
+{
+    const VisitEventHandler handler;
+    FILE *                  stream;
+    RuntimeContext *        context;
+    const ERD *             last;                     // previous sibling of next element (NULL if none)
+    char *                  next;                     // next unread byte in input buffer
+    char *                  limit;                    // one past last unread byte in input buffer
+    char                    text[LIMIT_NAME_LENGTH];  // text of last member name or value read
+    char                    block[LIMIT_BLOCK_SIZE];  // input buffer's storage
+} JSONReader;
+
+// JSONReader methods to pass to walkInfoset method
+
+extern const VisitEventHandler jsonReaderMethods;
+
+#endif // JSON_READER_H
@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "json_writer.h"
+#include <stdio.h>        // for fwrite
+#include <string.h>       // for memcpy, strlen
+#include "cli_errors.h"   // for CLI_JSON_WRITE
+#include "errors.h"       // for Error
+#include "number_text.h"  // for format_number, LIMIT_NUMBER_TEXT
+// clang-format on
+
+// Write the output buffer's bytes to the stream, emptying the buffer
+
+static const Error *
+jsonFlush(JSONWriter *writer)
+{
+    const size_t length = (size_t)(writer->next - writer->block);
+    const size_t count = fwrite(writer->block, 1, length, writer->stream);
+    writer->next = writer->block;
+    if (count < length)
+    {
+        static const Error error = {CLI_JSON_WRITE, {0}};
+        return &error;
+    }
+    return NULL;
+}
+
+// Write bytes into the output buffer, flushing it whenever it fills up
+
+static const Error *
+jsonWrite(JSONWriter *writer, const char *bytes, size_t length)
+{
+    while (length)
+    {
+        size_t room = (size_t)(writer->block + sizeof(writer->block) - writer->next);
+        if (!room)
+        {
+            const Error *error = jsonFlush(writer);
+            if (error) return error;
+            room = sizeof(writer->block);
+        }
+
+        const size_t count = length < room ? length : room;
+        memcpy(writer->next, bytes, count);
+        writer->next += count;
+        bytes += count;
+        length -= count;
+    }
+    return NULL;
+}
+
+// Write a newline and indent the next line by 2 spaces per level
+
+static const Error *
+jsonWriteNewline(JSONWriter *writer, size_t depth)
+{
+    static const char spaces[] = "\n                                ";
+    const size_t      most = (sizeof(spaces) - 2) / 2;
+    const Error *     error = jsonWrite(writer, spaces, 1 + 2 * (depth < most ? depth : most));
+    for (; depth > most && !error; depth -= most)
+    {
+        const size_t levels = depth - most < most ? depth - most : most;
+        error = jsonWrite(writer, spaces + 1, 2 * levels);
+    }
+    return error;
+}
+
+// Close the array of the previous sibling's items if it was an array
+// element which the next element doesn't continue
+
+static const Error *
+jsonCloseArray(JSONWriter *writer, const ERD *next)
+{
+    const Error *error = NULL;
+    if (writer->last && writer->last->isArray && writer->last != next)
+    {
+        writer->depth--;
+        error = jsonWriteNewline(writer, writer->depth);
+        if (!error)
+        {
+            error = jsonWrite(writer, "]", 1);
+        }
+    }
+    return error;
+}
+
+// Start writing an element: separate it from its previous sibling,
+// then write its name (and open an array for its items if it starts
+// an array element) unless it continues the array of its sibling
+
+static const Error *
+jsonStartElement(JSONWriter *writer, const ERD *erd)
+{
+    const bool   continues = erd->isArray && writer->last == erd;
+    const Error *error = jsonCloseArray(writer, erd);
+    if (!error && writer->last)
+    {
+        error = jsonWrite(writer, ",", 1);
+    }
+    if (!error)
+    {
+        error = jsonWriteNewline(writer, writer->depth);
+    }
+    if (!error && !continues)
+    {
+        const NamedQName *qname = &erd->namedQName;
+        error = jsonWrite(writer, "\"", 1);
+        if (!error)
+        {
+            error = jsonWrite(writer, qname->local, strlen(qname->local));
+        }
+        if (!error)
+        {
+            error = jsonWrite(writer, erd->isArray ? "\": [" : "\": ", erd->isArray ? 4 : 3);
+        }
+        if (!error && erd->isArray)
+        {
+            writer->depth++;
+            error = jsonWriteNewline(writer, writer->depth);
+        }
+    }
+    return error;
+}
+
+// Start a new JSON document with its outermost object
+
+static const Error *
+jsonStartDocument(JSONWriter *writer)
+{
+    writer->next = writer->block;
+    writer->last = NULL;
+    writer->depth = 1;
+    return jsonWrite(writer, "{", 1);
+}
+
+// End the JSON document and write the rest of it to the stream
+
+static const Error *
+jsonEndDocument(JSONWriter *writer)
+{
+    const Error *error = jsonCloseArray(writer, NULL);
+    if (!error)
+    {
+        error = jsonWrite(writer, "\n}\n", 3);
+    }
+    if (!error)
+    {
+        error = jsonFlush(writer);
+    }
+    return error;
+}
+
+// Write a complex element's name and start its object
+
+static const Error *
+jsonStartComplex(JSONWriter *writer, const InfosetBase *base)
+{
+    const Error *error = jsonStartElement(writer, base->erd);
+    if (!error)
+    {
+        error = jsonWrite(writer, "{", 1);
+    }
+    writer->last = NULL;
+    writer->depth++;
+    return error;
+}
+
+// End a complex element's object
+
+static const Error *
+jsonEndComplex(JSONWriter *writer, const InfosetBase *base)
+{
+    const Error *error = jsonCloseArray(writer, NULL);
+    writer->depth--;
+    if (!error)
+    {
+        error = jsonWriteNewline(writer, writer->depth);
+    }
+    if (!error)
+    {
+        error = jsonWrite(writer, "}", 1);
+    }
+    writer->last = base->erd;
+    return error;
+}
+
+// Write a number as a JSON string member's value (its text never
+// needs escaping)
+
+static const Error *
+jsonNumberElem(JSONWriter *writer, const ERD *erd, const void *number)
+{
+    char text[LIMIT_NUMBER_TEXT + 2];
+    text[0] = '"';
+    const size_t length = format_number(erd->typeCode, number, text + 1);
+    text[length + 1] = '"';
+
+    const Error *error = jsonStartElement(writer, erd);
+    if (!error)
+    {
+        error = jsonWrite(writer, text, length + 2);
+    }
+    writer->last = erd;
+    return error;
+}
+
+// Initialize a struct with our visitor event handler methods
+
+const VisitEventHandler jsonWriterMethods = {
+    (VisitStartDocument)&jsonStartDocument, (VisitEndDocument)&jsonEndDocument,
+    (VisitStartComplex)&jsonStartComplex,   (VisitEndComplex)&jsonEndComplex,
+    (VisitNumberElem)&jsonNumberElem,       NULL,
+};
@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+// clang-format off
+#include <stddef.h>   // for size_t
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for LIMIT_BLOCK_SIZE
+#include "infoset.h"  // for VisitEventHandler, RuntimeContext, ERD
+// clang-format on
+
+// JSONWriter - infoset visitor with methods to output JSON the same
+// way runtime1's JsonInfosetOutputter does (writes each element as a
+// member named by its local name with its value as a string, writes
+// the items of an array element as one array member, and indents by
+// 2 spaces, writing into its output buffer as it visits the infoset
+// and writing the output buffer to the stream only when the buffer
+// fills up or the document ends)
+
+typedef struct JSONWriter
+{
+    const VisitEventHandler handler;
+    FILE *                  stream;
+    RuntimeContext *        context;
+    const ERD *             last;                    // previous sibling of next element (NULL if none)
+    size_t                  depth;                   // indentation level of next element
+    char *                  next;                    // next unwritten byte in output buffer
+    char                    block[LIMIT_BLOCK_SIZE]; // output buffer's storage
+} JSONWriter;
+
+// JSONWriter methods to pass to walkInfoset method
+
+extern const VisitEventHandler jsonWriterMethods;
+
+#endif // JSON_WRITER_H
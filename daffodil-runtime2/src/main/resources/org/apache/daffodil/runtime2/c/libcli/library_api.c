@@ -0,0 +1,292 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "library_api.h"
+#include <stdbool.h>        // for bool, false, true
+#include <stdio.h>          // for fclose, fmemopen, open_memstream, FILE
+#include <stdlib.h>         // for free
+#include <string.h>         // for memcpy, strcmp
+#include "binary_reader.h"  // for binaryReaderMethods, BinaryReader
+#include "binary_writer.h"  // for binaryWriterMethods, BinaryWriter
+#include "cli_errors.h"     // for CLI_LIBRARY_INFOSET, CLI_LIBRARY_MEMORY, CLI_XML_GONE
+#include "errors.h"         // for copy_error, fprint_diagnostics, fprint_error, Error, Diagnostics
+#include "infoset.h"        // for walkInfoset, InfosetBase, PState, UState, RuntimeContext, new_context, free_context, ERD, VisitEventHandler
+#include "json_reader.h"    // for jsonReaderMethods, JSONReader
+#include "json_writer.h"    // for jsonWriterMethods, JSONWriter
+#include "parsers.h"        // for refill_from_memory
+#include "unparsers.h"      // for flush_to_stream
+#include "xml_reader.h"     // for xmlReaderMethods, XMLReader
+#include "xml_writer.h"     // for xmlWriterMethods, XMLWriter
+// clang-format on
+
+// Print any diagnostics to the messages and forget them
+
+static void
+print_and_forget(FILE *messages, Diagnostics **diagnostics)
+{
+    fprint_diagnostics(messages, *diagnostics);
+    if (*diagnostics)
+    {
+        (*diagnostics)->length = 0;
+        *diagnostics = NULL;
+    }
+}
+
+// Copy an error into the context before returning it, since the
+// error's string argument may point into a writer or reader on our
+// stack which is gone by the time callers print the error
+
+static const Error *
+keep_error(RuntimeContext *context, const Error *error)
+{
+    return copy_error(&context->error, context->errorText, sizeof(context->errorText), error);
+}
+
+// Get an error naming an infoset type we don't know
+
+static const Error *
+unknown_infoset_type(RuntimeContext *context, const char *infoset_type)
+{
+    Error *error = &context->error;
+    error->code = CLI_LIBRARY_INFOSET;
+    error->arg.s = infoset_type;
+    return error;
+}
+
+// parse_memory - parse length bytes of data into a context's infoset and
+// write the infoset to result as infoset_type ("xml", "json", or
+// "binary"), printing any diagnostics to messages
+
+const Error *
+parse_memory(RuntimeContext *context, const char *infoset_type, const char *data, size_t length, FILE *result,
+             FILE *messages)
+{
+    XMLWriter                xmlWriter = {xmlWriterMethods, result, context, NULL, {0}};
+    JSONWriter               jsonWriter = {jsonWriterMethods, result, context, NULL, 0, NULL, {0}};
+    BinaryWriter             binaryWriter = {binaryWriterMethods, result, context, NULL, {0}};
+    const VisitEventHandler *writer = NULL;
+    if (strcmp(infoset_type, "xml") == 0)
+    {
+        writer = (VisitEventHandler *)&xmlWriter;
+    }
+    else if (strcmp(infoset_type, "json") == 0)
+    {
+        writer = (VisitEventHandler *)&jsonWriter;
+    }
+    else if (strcmp(infoset_type, "binary") == 0)
+    {
+        writer = (VisitEventHandler *)&binaryWriter;
+    }
+    else
+    {
+        return unknown_infoset_type(context, infoset_type);
+    }
+
+    InfosetBase *root = context->root;
+    PState       pstate = {NULL, 0, NULL, NULL, context, data, data + length, &refill_from_memory, {0}};
+    root->erd->initSelf(root);
+    root->erd->parseSelf(root, &pstate);
+    print_and_forget(messages, &pstate.diagnostics);
+    if (pstate.error)
+    {
+        return pstate.error;
+    }
+    const Error *error = walkInfoset(writer, context);
+    return error ? keep_error(context, error) : NULL;
+}
+
+// unparse_memory - read a context's infoset from length bytes of
+// infoset_type data ("xml", "json", or "binary") and unparse the
+// infoset to result, printing any diagnostics to messages
+
+const Error *
+unparse_memory(RuntimeContext *context, const char *infoset_type, const char *data, size_t length,
+               FILE *result, FILE *messages)
+{
+    if (strcmp(infoset_type, "xml") != 0 && strcmp(infoset_type, "json") != 0 &&
+        strcmp(infoset_type, "binary") != 0)
+    {
+        return unknown_infoset_type(context, infoset_type);
+    }
+
+    // Some C libraries can't open an empty buffer as a stream
+    if (!length)
+    {
+        static const Error error = {CLI_XML_GONE, {0}};
+        return &error;
+    }
+    FILE *input = fmemopen((void *)data, length, "r");
+    if (!input)
+    {
+        static const Error error = {CLI_LIBRARY_MEMORY, {0}};
+        return &error;
+    }
+
+    XMLReader                xmlReader = {xmlReaderMethods, input, context, NULL, NULL, false, 0, 0, {0},
+                                          {0}, {0}};
+    JSONReader               jsonReader = {jsonReaderMethods, input, context, NULL, NULL, NULL, {0}, {0}};
+    BinaryReader             binaryReader = {binaryReaderMethods, input, context, NULL, NULL, {0}};
+    const VisitEventHandler *reader = (VisitEventHandler *)&xmlReader;
+    if (strcmp(infoset_type, "json") == 0)
+    {
+        reader = (VisitEventHandler *)&jsonReader;
+    }
+    else if (strcmp(infoset_type, "binary") == 0)
+    {
+        reader = (VisitEventHandler *)&binaryReader;
+    }
+
+    InfosetBase *root = context->root;
+    root->erd->initSelf(root);
+    const Error *error = walkInfoset(reader, context);
+    fclose(input);
+    if (error)
+    {
+        return keep_error(context, error);
+    }
+
+    UState ustate = {result, 0, NULL, NULL, context, NULL, NULL, &flush_to_stream, {0}};
+    root->erd->unparseSelf(root, &ustate);
+    if (!ustate.error)
+    {
+        ustate.error = ustate.flush(&ustate);
+    }
+    print_and_forget(messages, &ustate.diagnostics);
+    return ustate.error;
+}
+
+// daffodil_new_context, daffodil_free_context - allocate or free a
+// context for callers of the shared library (give each thread its own)
+
+RuntimeContext *
+daffodil_new_context(void)
+{
+    return new_context();
+}
+
+void
+daffodil_free_context(RuntimeContext *context)
+{
+    free_context(context);
+}
+
+// Copy a memory stream's bytes into a caller's buffer if they fit
+
+static bool
+copy_out(const char *bytes, size_t length, void *buffer, size_t capacity)
+{
+    if (length > capacity)
+    {
+        return false;
+    }
+    memcpy(buffer, bytes, length);
+    return true;
+}
+
+// Copy a memory stream's messages into a caller's buffer as a
+// NUL-terminated string, truncating them if they don't fit
+
+static void
+copy_messages(const char *bytes, size_t length, char *messages, size_t capacity)
+{
+    if (capacity)
+    {
+        length = length < capacity - 1 ? length : capacity - 1;
+        memcpy(messages, bytes, length);
+        messages[length] = '\0';
+    }
+}
+
+// Parse or unparse input into the caller's buffers through memory streams
+
+static int
+call_with_buffers(bool parse, RuntimeContext *context, const char *infoset_type, const void *input,
+                  size_t input_length, void *output, size_t output_capacity, size_t *output_length,
+                  char *messages, size_t messages_capacity)
+{
+    char * resultData = NULL;
+    size_t resultLength = 0;
+    char * messageData = NULL;
+    size_t messageLength = 0;
+    FILE * result = open_memstream(&resultData, &resultLength);
+    FILE * messageStream = open_memstream(&messageData, &messageLength);
+    *output_length = 0;
+    if (!result || !messageStream)
+    {
+        if (result) fclose(result);
+        if (messageStream) fclose(messageStream);
+        free(resultData);
+        free(messageData);
+        static const Error error = {CLI_LIBRARY_MEMORY, {0}};
+        FILE *             stream = messages_capacity ? fmemopen(messages, messages_capacity, "w") : NULL;
+        if (stream)
+        {
+            fprint_error(stream, &error);
+            fclose(stream);
+        }
+        return LIBRARY_ERROR;
+    }
+
+    const Error *error =
+        parse ? parse_memory(context, infoset_type, input, input_length, result, messageStream)
+              : unparse_memory(context, infoset_type, input, input_length, result, messageStream);
+    if (error)
+    {
+        fprint_error(messageStream, error);
+    }
+
+    // Close the memory streams to fix their final lengths
+    fclose(result);
+    fclose(messageStream);
+    int status = error ? LIBRARY_ERROR : LIBRARY_OK;
+    *output_length = resultLength;
+    if (!copy_out(resultData, resultLength, output, output_capacity) && !error)
+    {
+        status = LIBRARY_FULL;
+    }
+    copy_messages(messageData, messageLength, messages, messages_capacity);
+    free(resultData);
+    free(messageData);
+    return status;
+}
+
+// daffodil_parse_buffer, daffodil_unparse_buffer - parse or unparse
+// input_length bytes of input into the caller's output buffer (parsing
+// writes an infoset_type infoset, unparsing reads one), setting
+// *output_length to the number of bytes the output needs and writing
+// any diagnostics or error messages into the caller's messages buffer
+// as a NUL-terminated (and maybe truncated) string; returns a
+// LibraryStatus (LIBRARY_FULL means call again with a bigger buffer)
+
+int
+daffodil_parse_buffer(RuntimeContext *context, const char *infoset_type, const void *input,
+                      size_t input_length, void *output, size_t output_capacity, size_t *output_length,
+                      char *messages, size_t messages_capacity)
+{
+    return call_with_buffers(true, context, infoset_type, input, input_length, output, output_capacity,
+                             output_length, messages, messages_capacity);
+}
+
+int
+daffodil_unparse_buffer(RuntimeContext *context, const char *infoset_type, const void *input,
+                        size_t input_length, void *output, size_t output_capacity, size_t *output_length,
+                        char *messages, size_t messages_capacity)
+{
+    return call_with_buffers(false, context, infoset_type, input, input_length, output, output_capacity,
+                             output_length, messages, messages_capacity);
+}
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIBRARY_API_H
+#define LIBRARY_API_H
+
+// clang-format off
+#include <stddef.h>   // for size_t
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for Error
+#include "infoset.h"  // for RuntimeContext
+// clang-format on
+
+// LibraryStatus - results of daffodil_parse_buffer and
+// daffodil_unparse_buffer
+
+enum LibraryStatus
+{
+    LIBRARY_OK = 0,    // call succeeded (messages hold any diagnostics)
+    LIBRARY_ERROR = 1, // call failed (messages say why)
+    LIBRARY_FULL = 2,  // call succeeded but output needs output_length bytes
+};
+
+// parse_memory - parse length bytes of data into a context's infoset and
+// write the infoset to result as infoset_type ("xml", "json", or
+// "binary"), printing any diagnostics to messages
+
+extern const Error *parse_memory(RuntimeContext *context, const char *infoset_type, const char *data,
+                                 size_t length, FILE *result, FILE *messages);
+
+// unparse_memory - read a context's infoset from length bytes of
+// infoset_type data ("xml", "json", or "binary") and unparse the
+// infoset to result, printing any diagnostics to messages
+
+extern const Error *unparse_memory(RuntimeContext *context, const char *infoset_type, const char *data,
+                                   size_t length, FILE *result, FILE *messages);
+
+// daffodil_new_context, daffodil_free_context - allocate or free a
+// context for callers of the shared library (give each thread its own)
+
+extern RuntimeContext *daffodil_new_context(void);
+extern void            daffodil_free_context(RuntimeContext *context);
+
+// daffodil_parse_buffer, daffodil_unparse_buffer - parse or unparse
+// input_length bytes of input into the caller's output buffer (parsing
+// writes an infoset_type infoset, unparsing reads one), setting
+// *output_length to the number of bytes the output needs and writing
+// any diagnostics or error messages into the caller's messages buffer
+// as a NUL-terminated (and maybe truncated) string; returns a
+// LibraryStatus (LIBRARY_FULL means call again with a bigger buffer)
+
+extern int daffodil_parse_buffer(RuntimeContext *context, const char *infoset_type, const void *input,
+                                 size_t input_length, void *output, size_t output_capacity,
+                                 size_t *output_length, char *messages, size_t messages_capacity);
+extern int daffodil_unparse_buffer(RuntimeContext *context, const char *infoset_type, const void *input,
+                                   size_t input_length, void *output, size_t output_capacity,
+                                   size_t *output_length, char *messages, size_t messages_capacity);
+
+#endif // LIBRARY_API_H
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "null_writer.h"
+#include <stddef.h>  // for size_t, NULL
+#include <stdint.h>  // for uint64_t, uint8_t
+#include "errors.h"  // for Error, UNUSED
+// clang-format on
+
+// FNV-1a's 64-bit offset basis and prime
+
+#define FNV_OFFSET 0xcbf29ce484222325u
+#define FNV_PRIME 0x100000001b3u
+
+// Fold bytes into the current record's hash
+
+static void
+nullHash(NullWriter *writer, const void *bytes, size_t length)
+{
+    const uint8_t *byte = bytes;
+    uint64_t       hash = writer->hash;
+    size_t         i;
+    for (i = 0; i < length; i++)
+    {
+        hash = (hash ^ byte[i]) * FNV_PRIME;
+    }
+    writer->hash = hash;
+}
+
+// Start a new record's hash
+
+static const Error *
+nullStartDocument(NullWriter *writer)
+{
+    writer->hash = FNV_OFFSET;
+    return NULL;
+}
+
+// Add the record's hash to the checksum
+
+static const Error *
+nullEndDocument(NullWriter *writer)
+{
+    writer->checksum += writer->hash;
+    return NULL;
+}
+
+// Discard a complex element's start
+
+static const Error *
+nullStartComplex(NullWriter *writer, const InfosetBase *base)
+{
+    UNUSED(writer);
+    UNUSED(base);
+    return NULL;
+}
+
+// Discard a complex element's end
+
+static const Error *
+nullEndComplex(NullWriter *writer, const InfosetBase *base)
+{
+    UNUSED(writer);
+    UNUSED(base);
+    return NULL;
+}
+
+// Fold a number's bytes into the record's hash
+
+static const Error *
+nullNumberElem(NullWriter *writer, const ERD *erd, const void *number)
+{
+    nullHash(writer, number, numberSize(erd->typeCode));
+    return NULL;
+}
+
+// Fold a run of adjacent numbers' bytes into the record's hash at once
+
+static const Error *
+nullNumberRun(NullWriter *writer, const ERD *const *erds, const void *numbers, size_t count)
+{
+    nullHash(writer, numbers, count * numberSize(erds[0]->typeCode));
+    return NULL;
+}
+
+// Initialize a struct with our visitor event handler methods
+
+const VisitEventHandler nullWriterMethods = {
+    (VisitStartDocument)&nullStartDocument, (VisitEndDocument)&nullEndDocument,
+    (VisitStartComplex)&nullStartComplex,   (VisitEndComplex)&nullEndComplex,
+    (VisitNumberElem)&nullNumberElem,       (VisitNumberRun)&nullNumberRun,
+};
@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NULL_WRITER_H
+#define NULL_WRITER_H
+
+// clang-format off
+#include <stdint.h>   // for uint64_t
+#include "infoset.h"  // for VisitEventHandler
+// clang-format on
+
+// NullWriter - infoset visitor with methods to discard the infoset
+// while folding its values into a checksum, letting benchmarks measure
+// parsing alone (each record's values are hashed with 64-bit FNV-1a
+// and the records' hashes are summed, so threads parsing records in
+// any order can add their checksums together)
+
+typedef struct NullWriter
+{
+    const VisitEventHandler handler;
+    uint64_t                checksum; // sum of all visited records' hashes
+    uint64_t                hash;     // hash of current record's values
+} NullWriter;
+
+// NullWriter methods to pass to walkInfoset method
+
+extern const VisitEventHandler nullWriterMethods;
+
+#endif // NULL_WRITER_H
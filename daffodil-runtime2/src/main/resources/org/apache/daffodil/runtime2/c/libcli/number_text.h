@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NUMBER_TEXT_H
+#define NUMBER_TEXT_H
+
+// clang-format off
+#include <stddef.h>   // for size_t
+#include <stdint.h>   // for int64_t, uint64_t
+#include "errors.h"   // for Error
+#include "infoset.h"  // for TypeCode
+// clang-format on
+
+// Limits on how many characters number text can need
+
+enum NumberLimits
+{
+    LIMIT_NUMBER_TEXT = 32 // enough for any formatted number plus its NUL
+};
+
+// NumberParse - results of converting text to a number
+
+typedef enum NumberParse
+{
+    NUMBER_OK,    // text holds a number in range
+    NUMBER_EMPTY, // text has no number
+    NUMBER_NOT,   // text has other characters after its number
+    NUMBER_RANGE, // text's number is out of range
+    NUMBER_TYPE,  // type isn't a boolean or number
+} NumberParse;
+
+// format_int64, format_uint64 - write an integer's decimal digits and
+// a NUL into text, returning how many digits (and sign) it wrote
+
+extern size_t format_int64(int64_t number, char *text);
+extern size_t format_uint64(uint64_t number, char *text);
+
+// format_double, format_float - write a real number's shortest text
+// which reads back as the same number and a NUL into text, returning
+// how many characters it wrote (uses the same canonical syntax as
+// runtime1: 1.0, 0.001, 1.0E7, 3.4028235E38, INF, -INF, NaN)
+
+extern size_t format_double(double number, char *text);
+extern size_t format_float(float number, char *text);
+
+// parse_int64, parse_uint64 - convert a decimal integer's text (with
+// optional sign and surrounding XML whitespace) to a number within
+// the given range, setting number only if returning NUMBER_OK (an
+// unsigned number can be written -0, but any other negative number
+// is out of range)
+
+extern NumberParse parse_int64(const char *text, int64_t minval, int64_t maxval, int64_t *number);
+extern NumberParse parse_uint64(const char *text, uint64_t maxval, uint64_t *number);
+
+// parse_double, parse_float - convert a real number's text to the
+// nearest double or float without depending on locale (short decimals
+// take a fast path, most others use the Eisel-Lemire algorithm, and
+// only INF, NaN, subnormals, and very long decimals need strtod),
+// returning NUMBER_RANGE if the number overflows to infinity or has
+// nonzero digits but underflows to zero, while subnormals read back
+
+extern NumberParse parse_double(const char *text, double *number);
+extern NumberParse parse_float(const char *text, float *number);
+
+// format_number - write a boolean's or number's text and a NUL into
+// text, returning how many characters it wrote (0 for an unknown type)
+
+extern size_t format_number(enum TypeCode typeCode, const void *number, char *text);
+
+// parse_number - convert a boolean's or number's text to the given
+// type, setting number only if returning NUMBER_OK
+
+extern NumberParse parse_number(enum TypeCode typeCode, const char *text, void *number);
+
+// number_error - report any error converting an element's text with
+// parse_number, filling in and returning slot (NULL if no error)
+
+extern const Error *number_error(NumberParse result, enum TypeCode typeCode, const char *text, Error *slot);
+
+#endif // NUMBER_TEXT_H
@@ -0,0 +1,367 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "parallel_parse.h"
+#include <pthread.h>        // for pthread_cond_broadcast, pthread_cond_wait, pthread_mutex_lock, pthread_mutex_unlock, pthread_create, pthread_join, pthread_t, PTHREAD_COND_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, pthread_cond_t, pthread_mutex_t
+#include <stdbool.h>        // for bool, false, true
+#include <stdint.h>         // for uint64_t
+#include <stdio.h>          // for fclose, fputc, fwrite, open_memstream, stderr, FILE
+#include <stdlib.h>         // for calloc, free
+#include <string.h>         // for strcmp
+#include "binary_writer.h"  // for binaryWriterMethods, BinaryWriter
+#include "cli_errors.h"     // for CLI_NEW_CONTEXT, CLI_PARALLEL_MEMORY, CLI_PARALLEL_THREAD, CLI_XML_WRITE, LIMIT_PARALLEL_CHUNK
+#include "column_writer.h"  // for columnWriterMethods, copy_columns, flush_columns, free_columns, ColumnWriter
+#include "errors.h"         // for fprint_diagnostics, Error
+#include "infoset.h"        // for RuntimeContext, PState, new_context, free_context, walkInfoset, InfosetBase, ERD, VisitEventHandler
+#include "json_writer.h"    // for jsonWriterMethods, JSONWriter
+#include "null_writer.h"    // for nullWriterMethods, NullWriter
+#include "parsers.h"        // for refill_from_memory
+#include "xml_writer.h"     // for xmlWriterMethods, XMLWriter
+// clang-format on
+
+// Chunk - a run of consecutive records and the infosets and diagnostics
+// written from them by whichever thread parsed them
+
+typedef struct Chunk
+{
+    char *       xml;             // infosets written from chunk's records
+    size_t       length;          // number of bytes in xml
+    char *       messages;        // diagnostics printed for chunk's records
+    size_t       messages_length; // number of bytes in messages
+    uint64_t     checksum;        // checksum of chunk's records when writing null
+    const Error *error;           // any error which stopped parsing chunk
+    bool         done;            // whether a thread has finished chunk
+} Chunk;
+
+// Pipeline - state shared by the threads parsing chunks and the
+// thread writing chunks in order (threads may parse only a window of
+// chunks ahead of the writer, bounding how much memory chunks use)
+
+typedef struct Pipeline
+{
+    const char *        start;         // first byte of first record
+    size_t              record_length; // number of bytes in each record
+    size_t              num_records;   // number of records to parse
+    size_t              chunk_records; // number of records in each chunk
+    size_t              num_chunks;    // number of chunks to parse
+    const char *        converter;     // infoset type to write
+    const ColumnWriter *columns;       // columns learned by main's writer
+    Chunk *             window;        // ring of chunks being parsed
+    size_t              window_size;   // number of chunks in ring
+    size_t              claimed;       // number of chunks threads have claimed
+    size_t              written;       // number of chunks writer has written
+    bool                stop;          // whether threads must stop now
+    pthread_mutex_t     mutex;         // guards everything above
+    pthread_cond_t      changed;       // signals claimed, written, done, or stop changed
+} Pipeline;
+
+// Parse one chunk's records and write their infosets and diagnostics
+// into the chunk (the writer prints the diagnostics in chunk order)
+
+static const Error *
+parse_chunk(const Pipeline *pipeline, size_t index, Chunk *chunk, PState *pstate)
+{
+    RuntimeContext *context = pstate->context;
+    InfosetBase *   root = context->root;
+
+    // Point the input buffer at the chunk's records
+    const size_t first = index * pipeline->chunk_records;
+    const size_t last = first + pipeline->chunk_records < pipeline->num_records
+                            ? first + pipeline->chunk_records
+                            : pipeline->num_records;
+    pstate->next = pipeline->start + first * pipeline->record_length;
+    pstate->limit = pipeline->start + last * pipeline->record_length;
+
+    // Write the chunk's infosets and diagnostics into memory
+    FILE *stream = open_memstream(&chunk->xml, &chunk->length);
+    FILE *messages = stream ? open_memstream(&chunk->messages, &chunk->messages_length) : NULL;
+    if (!messages)
+    {
+        if (stream)
+        {
+            fclose(stream);
+        }
+        static const Error error = {CLI_PARALLEL_MEMORY, {0}};
+        return &error;
+    }
+    XMLWriter                xmlWriter = {xmlWriterMethods, stream, context, NULL, {0}};
+    JSONWriter               jsonWriter = {jsonWriterMethods, stream, context, NULL, 0, NULL, {0}};
+    BinaryWriter             binaryWriter = {binaryWriterMethods, stream, context, NULL, {0}};
+    ColumnWriter             columnWriter = {columnWriterMethods, stream, context, false, false, NULL, 0, 0,
+                                             0, NULL, 0, 0, {0}};
+    NullWriter               nullWriter = {nullWriterMethods, 0, 0};
+    const VisitEventHandler *writer = (VisitEventHandler *)&xmlWriter;
+    const bool               columns = strcmp(pipeline->converter, "columns") == 0;
+    const Error *            error = NULL;
+    if (strcmp(pipeline->converter, "json") == 0)
+    {
+        writer = (VisitEventHandler *)&jsonWriter;
+    }
+    else if (strcmp(pipeline->converter, "binary") == 0)
+    {
+        writer = (VisitEventHandler *)&binaryWriter;
+    }
+    else if (columns)
+    {
+        // Start with main's columns so every batch matches the header
+        // main's writer already wrote
+        writer = (VisitEventHandler *)&columnWriter;
+        error = copy_columns(&columnWriter, pipeline->columns);
+    }
+    else if (strcmp(pipeline->converter, "null") == 0)
+    {
+        writer = (VisitEventHandler *)&nullWriter;
+    }
+    const bool separate = !columns && writer != (VisitEventHandler *)&nullWriter;
+
+    // Parse each record just like the serial loop in main does
+    size_t i;
+    for (i = first; i < last && !error; i++)
+    {
+        if (separate)
+        {
+            fputc('\0', stream);
+        }
+        root->erd->initSelf(root);
+        pstate->position = 0;
+        root->erd->parseSelf(root, pstate);
+        fprint_diagnostics(messages, pstate->diagnostics);
+        if (pstate->diagnostics)
+        {
+            pstate->diagnostics->length = 0;
+            pstate->diagnostics = NULL;
+        }
+        error = pstate->error;
+        if (!error)
+        {
+            error = walkInfoset(writer, context);
+        }
+    }
+
+    // Write the rows before any failed record just like main does
+    if (columns)
+    {
+        const Error *error_flush = flush_columns(&columnWriter);
+        error = error ? error : error_flush;
+        free_columns(&columnWriter);
+    }
+    chunk->checksum = nullWriter.checksum;
+
+    const bool closed = fclose(messages) == 0;
+    if ((fclose(stream) != 0 || !closed) && !error)
+    {
+        static const Error error_memory = {CLI_PARALLEL_MEMORY, {0}};
+        error = &error_memory;
+    }
+    return error;
+}
+
+// Claim and parse chunks until none are left or the writer stops us
+
+static void *
+parse_chunks(void *arg)
+{
+    Pipeline *pipeline = arg;
+
+    // Give this thread its own context and input buffer
+    RuntimeContext *context = new_context();
+    PState          pstate = {NULL, 0, NULL, NULL, context, NULL, NULL, &refill_from_memory, {0}};
+    bool            failed = false;
+
+    pthread_mutex_lock(&pipeline->mutex);
+    while (!pipeline->stop && pipeline->claimed < pipeline->num_chunks)
+    {
+        // Wait until the chunk we would claim fits within the window
+        const size_t index = pipeline->claimed;
+        if (index >= pipeline->written + pipeline->window_size)
+        {
+            pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+            continue;
+        }
+        pipeline->claimed++;
+        Chunk *chunk = &pipeline->window[index % pipeline->window_size];
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        // Parse the chunk without holding the lock
+        const Error *error = NULL;
+        if (!context)
+        {
+            static const Error error_context = {CLI_NEW_CONTEXT, {0}};
+            error = &error_context;
+        }
+        else
+        {
+            error = parse_chunk(pipeline, index, chunk, &pstate);
+        }
+        failed = failed || error;
+
+        pthread_mutex_lock(&pipeline->mutex);
+        chunk->error = error;
+        chunk->done = true;
+        pthread_cond_broadcast(&pipeline->changed);
+    }
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    // Keep our context if our error refers to it (program will exit)
+    if (!failed)
+    {
+        free_context(context);
+    }
+    return NULL;
+}
+
+// Write parsed chunks to output in order until all are written or one
+// has an error, adding their checksums to checksum
+
+static const Error *
+write_chunks(Pipeline *pipeline, FILE *output, uint64_t *checksum)
+{
+    const Error *error = NULL;
+    size_t       index;
+    for (index = 0; index < pipeline->num_chunks && !error; index++)
+    {
+        Chunk *chunk = &pipeline->window[index % pipeline->window_size];
+
+        pthread_mutex_lock(&pipeline->mutex);
+        while (!chunk->done)
+        {
+            pthread_cond_wait(&pipeline->changed, &pipeline->mutex);
+        }
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        // Write even a failed chunk's diagnostics and infosets so output
+        // matches what parsing the records one after another would have
+        // written
+        if (chunk->messages)
+        {
+            fwrite(chunk->messages, 1, chunk->messages_length, stderr);
+        }
+        if (chunk->xml && fwrite(chunk->xml, 1, chunk->length, output) < chunk->length)
+        {
+            static const Error error_write = {CLI_XML_WRITE, {0}};
+            error = &error_write;
+        }
+        error = chunk->error ? chunk->error : error;
+        *checksum += chunk->checksum;
+        free(chunk->xml);
+        free(chunk->messages);
+
+        pthread_mutex_lock(&pipeline->mutex);
+        chunk->xml = NULL;
+        chunk->length = 0;
+        chunk->messages = NULL;
+        chunk->messages_length = 0;
+        chunk->checksum = 0;
+        chunk->done = false;
+        pipeline->written++;
+        pipeline->stop = error != NULL;
+        pthread_cond_broadcast(&pipeline->changed);
+        pthread_mutex_unlock(&pipeline->mutex);
+    }
+    return error;
+}
+
+// parallel_parse - parse all of the complete records left in pstate's
+// input buffer on a pool of threads and write their infosets to output
+// in order, each preceded by a NUL character unless written as rows of
+// columns (caller must have parsed the first record already and every
+// record must have the same length, while infoset_converter names the
+// infoset type to write, the records' checksum is added to checksum
+// when that type is null, and every record must match the columns
+// learned by the caller's column writer when that type is columns)
+
+const Error *
+parallel_parse(PState *pstate, size_t record_length, FILE *output, size_t jobs, const char *infoset_converter,
+               const ColumnWriter *columns, uint64_t *checksum)
+{
+    // Give each chunk enough records to make handing it off worthwhile
+    const size_t num_records = (size_t)(pstate->limit - pstate->next) / record_length;
+    size_t       chunk_records = LIMIT_PARALLEL_CHUNK / record_length;
+    chunk_records = chunk_records ? chunk_records : 1;
+    const size_t num_chunks = (num_records + chunk_records - 1) / chunk_records;
+    if (!num_chunks)
+    {
+        return NULL;
+    }
+    jobs = jobs < num_chunks ? jobs : num_chunks;
+
+    Pipeline pipeline = {pstate->next,
+                         record_length,
+                         num_records,
+                         chunk_records,
+                         num_chunks,
+                         infoset_converter,
+                         columns,
+                         NULL,
+                         2 * jobs,
+                         0,
+                         0,
+                         false,
+                         PTHREAD_MUTEX_INITIALIZER,
+                         PTHREAD_COND_INITIALIZER};
+    pipeline.window = calloc(pipeline.window_size, sizeof(Chunk));
+    pthread_t *threads = calloc(jobs, sizeof(pthread_t));
+    if (!pipeline.window || !threads)
+    {
+        free(pipeline.window);
+        free(threads);
+        static const Error error = {CLI_PARALLEL_MEMORY, {0}};
+        return &error;
+    }
+
+    // Start our threads, then write their chunks as they finish them
+    const Error *error = NULL;
+    size_t       started;
+    for (started = 0; started < jobs; started++)
+    {
+        if (pthread_create(&threads[started], NULL, &parse_chunks, &pipeline) != 0)
+        {
+            static const Error error_thread = {CLI_PARALLEL_THREAD, {0}};
+            error = &error_thread;
+            break;
+        }
+    }
+    if (error)
+    {
+        pthread_mutex_lock(&pipeline.mutex);
+        pipeline.stop = true;
+        pthread_cond_broadcast(&pipeline.changed);
+        pthread_mutex_unlock(&pipeline.mutex);
+    }
+    else
+    {
+        error = write_chunks(&pipeline, output, checksum);
+    }
+
+    size_t i;
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    for (i = 0; i < pipeline.window_size; i++)
+    {
+        free(pipeline.window[i].xml);
+        free(pipeline.window[i].messages);
+    }
+    free(pipeline.window);
+    free(threads);
+
+    // Tell caller we consumed all of the complete records
+    pstate->next += num_records * record_length;
+    return error;
+}
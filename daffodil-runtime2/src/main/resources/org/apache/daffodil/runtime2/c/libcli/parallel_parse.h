@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARALLEL_PARSE_H
+#define PARALLEL_PARSE_H
+
+// clang-format off
+#include <stddef.h>         // for size_t
+#include <stdint.h>         // for uint64_t
+#include <stdio.h>          // for FILE
+#include "column_writer.h"  // for ColumnWriter
+#include "errors.h"         // for Error
+#include "infoset.h"        // for PState
+// clang-format on
+
+// parallel_parse - parse all of the complete records left in pstate's
+// input buffer on a pool of threads and write their infosets to output
+// in order, each preceded by a NUL character unless written as rows of
+// columns (caller must have parsed the first record already and every
+// record must have the same length, while infoset_converter names the
+// infoset type to write, the records' checksum is added to checksum
+// when that type is null, and every record must match the columns
+// learned by the caller's column writer when that type is columns)
+
+extern const Error *parallel_parse(PState *pstate, size_t record_length, FILE *output, size_t jobs,
+                                   const char *infoset_converter, const ColumnWriter *columns,
+                                   uint64_t *checksum);
+
+#endif // PARALLEL_PARSE_H
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// clang-format off
+#include "serve_requests.h"
+#include <stdbool.h>      // for bool, false, true
+#include <stdint.h>       // for uint32_t, uint8_t
+#include <stdio.h>        // for fclose, fflush, fgetc, fread, fwrite, open_memstream, FILE, EOF
+#include <stdlib.h>       // for free, realloc
+#include "cli_errors.h"   // for CLI_SERVE_INPUT, CLI_SERVE_MEMORY, CLI_SERVE_REQUEST, CLI_SERVE_WRITE
+#include "errors.h"       // for fprint_error, Error
+#include "infoset.h"      // for RuntimeContext
+#include "library_api.h"  // for parse_memory, unparse_memory
+// clang-format on
+
+// Read a 4-byte big-endian length from the stream
+
+static const Error *
+serveReadLength(FILE *input, uint32_t *length)
+{
+    uint8_t bytes[4];
+    if (fread(bytes, 1, sizeof(bytes), input) < sizeof(bytes))
+    {
+        static const Error error = {CLI_SERVE_INPUT, {0}};
+        return &error;
+    }
+    *length = (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+    return NULL;
+}
+
+// Write a 4-byte big-endian length and that many bytes to the stream
+
+static bool
+serveWriteFrame(FILE *output, const char *data, size_t length)
+{
+    const uint8_t bytes[4] = {(uint8_t)(length >> 24), (uint8_t)(length >> 16), (uint8_t)(length >> 8),
+                              (uint8_t)length};
+    return fwrite(bytes, 1, sizeof(bytes), output) == sizeof(bytes) &&
+           fwrite(data, 1, length, output) == length;
+}
+
+// Carry out one command on its data and write its reply to output
+
+static const Error *
+serveRequest(RuntimeContext *context, int command, char *data, size_t length, FILE *output)
+{
+    char * resultData = NULL;
+    size_t resultLength = 0;
+    char * messageData = NULL;
+    size_t messageLength = 0;
+    FILE * result = open_memstream(&resultData, &resultLength);
+    FILE * messages = open_memstream(&messageData, &messageLength);
+    if (!result || !messages)
+    {
+        if (result) fclose(result);
+        if (messages) fclose(messages);
+        free(resultData);
+        free(messageData);
+        static const Error error = {CLI_SERVE_MEMORY, {0}};
+        return &error;
+    }
+
+    const Error *error = NULL;
+    if (command == SERVE_PARSE)
+    {
+        error = parse_memory(context, "xml", data, length, result, messages);
+    }
+    else
+    {
+        error = unparse_memory(context, "xml", data, length, result, messages);
+    }
+    if (error)
+    {
+        fprint_error(messages, error);
+    }
+
+    // Close the memory streams to fix their final lengths
+    bool ok = fclose(result) == 0;
+    ok = fclose(messages) == 0 && ok;
+    if (ok)
+    {
+        const uint8_t status = error ? SERVE_ERROR : SERVE_OK;
+        ok = fwrite(&status, 1, 1, output) == 1 && serveWriteFrame(output, resultData, resultLength) &&
+             serveWriteFrame(output, messageData, messageLength) && fflush(output) == 0;
+    }
+    free(resultData);
+    free(messageData);
+    if (!ok)
+    {
+        static const Error error_write = {CLI_SERVE_WRITE, {0}};
+        return &error_write;
+    }
+    return NULL;
+}
+
+// serve_requests - read requests from input and carry them out in a
+// context, writing a reply to each on output until input has no more
+// requests
+
+const Error *
+serve_requests(RuntimeContext *context, FILE *input, FILE *output)
+{
+    char *       data = NULL;
+    size_t       capacity = 0;
+    const Error *error = NULL;
+    int          command;
+    while (!error && (command = fgetc(input)) != EOF)
+    {
+        uint32_t length = 0;
+        error = serveReadLength(input, &length);
+        if (!error && command != SERVE_PARSE && command != SERVE_UNPARSE)
+        {
+            Error *error_request = &context->error;
+            error_request->code = CLI_SERVE_REQUEST;
+            error_request->arg.c = command;
+            error = error_request;
+        }
+
+        // Grow our buffer to hold the request's data, then read it
+        if (!error && length > capacity)
+        {
+            char *bigger = realloc(data, length);
+            if (!bigger)
+            {
+                static const Error error_memory = {CLI_SERVE_MEMORY, {0}};
+                error = &error_memory;
+            }
+            else
+            {
+                data = bigger;
+                capacity = length;
+            }
+        }
+        if (!error && fread(data, 1, length, input) < length)
+        {
+            static const Error error_input = {CLI_SERVE_INPUT, {0}};
+            error = &error_input;
+        }
+
+        if (!error)
+        {
+            error = serveRequest(context, command, data, length, output);
+        }
+    }
+    free(data);
+    return error;
+}
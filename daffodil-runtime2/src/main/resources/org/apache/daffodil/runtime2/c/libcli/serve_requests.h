@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVE_REQUESTS_H
+#define SERVE_REQUESTS_H
+
+// clang-format off
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for Error
+#include "infoset.h"  // for RuntimeContext
+// clang-format on
+
+// Serve protocol - framed requests and replies which let a long-lived
+// process parse and unparse many times without restarting.  Each
+// request is a 1-byte ServeCommand, a 4-byte big-endian length, and
+// that many bytes of data to parse or XML infoset to unparse.  Each
+// reply is a 1-byte ServeStatus, a 4-byte big-endian length and that
+// many bytes of XML infoset or unparsed data, then a 4-byte big-endian
+// length and that many bytes of error and diagnostic messages (the
+// same text the parse and unparse commands write on stderr).
+
+enum ServeCommand
+{
+    SERVE_PARSE = 'p',   // parse data into an XML infoset
+    SERVE_UNPARSE = 'u', // unparse an XML infoset into data
+};
+
+enum ServeStatus
+{
+    SERVE_OK = 0,    // command succeeded (messages hold any diagnostics)
+    SERVE_ERROR = 1, // command failed (messages say why)
+};
+
+// serve_requests - read requests from input and carry them out in a
+// context, writing a reply to each on output until input has no more
+// requests
+
+extern const Error *serve_requests(RuntimeContext *context, FILE *input, FILE *output);
+
+#endif // SERVE_REQUESTS_H
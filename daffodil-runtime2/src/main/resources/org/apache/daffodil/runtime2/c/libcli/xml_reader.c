@@ -17,309 +17,675 @@
 
 // clang-format off
 #include "xml_reader.h"
-#include <assert.h>      // for assert
-#include <errno.h>       // for errno
-#include <inttypes.h>    // for strtoimax, strtoumax
-#include <mxml.h>        // for mxmlWalkNext, mxmlGetElement, mxmlGetType, MXML_DESCEND, MXML_OPAQUE, mxmlDelete, mxmlGetOpaque, mxmlLoadFile, MXML_OPAQUE_CALLBACK
-#include <stdbool.h>     // for bool, false, true
-#include <stdint.h>      // for intmax_t, uintmax_t, int16_t, int32_t, int64_t, int8_t, uint16_t, uint32_t, uint64_t, uint8_t, INT16_MAX, INT16_MIN, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN, INT8_MAX, INT8_MIN, UINT16_MAX, UINT32_MAX, UINT64_MAX, UINT8_MAX
-#include <stdlib.h>      // for strtod, strtof
-#include <string.h>      // for strcmp, strlen, strncmp
-#include "cli_errors.h"  // for CLI_STRTONUM_EMPTY, CLI_STRTONUM_NOT, CLI_XML_GONE, CLI_STRTOD_ERRNO, CLI_STRTOI_ERRNO, CLI_STRTONUM_RANGE, CLI_XML_MISMATCH, CLI_STRTOBOOL, CLI_XML_ERD, CLI_XML_INPUT, CLI_XML_LEFT
-#include "errors.h"      // for Error, Error::(anonymous), UNUSED
+#include <stdbool.h>      // for bool, false, true
+#include <stdint.h>       // for uint32_t, uint8_t, int64_t
+#include <stdio.h>        // for fread, ferror, EOF
+#include <string.h>       // for memchr, memmove, memcmp
+#include "cli_errors.h"   // for CLI_XML_GONE, CLI_XML_MISMATCH, CLI_XML_INPUT, CLI_XML_LEFT, CLI_XML_LONG, CLI_XML_SYNTAX
+#include "errors.h"       // for Error, Error::(anonymous), UNUSED, LIMIT_NAME_LENGTH
+#include "number_text.h"  // for parse_number, number_error, NumberParse
 // clang-format on
 
-// Convert an XML element's text to a boolean with error checking
+// Refill the input buffer until it holds at least the given number of
+// unread bytes or the stream has no more bytes (keeps any unread bytes)
 
-static bool
-strtobool(const char *numptr, const Error **errorptr)
+static const Error *
+xmlFill(XMLReader *reader, size_t needed)
 {
-    // The lexical space of xs:boolean accepts true, false, 1, and 0
-    bool value = false;
-
-    // Check for any errors converting the string to a boolean
-    if (strcmp(numptr, "true") == 0)
-    {
-        value = true;
-    }
-    else if (strcmp(numptr, "false") == 0)
-    {
-        value = false;
-    }
-    else if (strcmp(numptr, "1") == 0)
+    size_t unread = (size_t)(reader->limit - reader->next);
+    if (unread >= needed)
     {
-        value = true;
+        return NULL;
     }
-    else if (strcmp(numptr, "0") == 0)
+
+    // Move any unread bytes to the front of the input buffer
+    memmove(reader->block, reader->next, unread);
+    reader->next = reader->block;
+    reader->limit = reader->block + unread;
+
+    // Read until we have enough bytes or reach the end of the stream
+    while (unread < needed && !feof(reader->stream))
     {
-        value = false;
+        const size_t count = fread(reader->limit, 1, sizeof(reader->block) - unread, reader->stream);
+        reader->limit += count;
+        unread += count;
+        if (ferror(reader->stream))
+        {
+            static const Error error = {CLI_XML_INPUT, {0}};
+            return &error;
+        }
     }
-    else
+    return NULL;
+}
+
+// Peek at the unread byte at the given offset without consuming it
+// (returns EOF if the stream has no byte at that offset)
+
+static int
+xmlPeek(XMLReader *reader, size_t offset, const Error **errorptr)
+{
+    if ((size_t)(reader->limit - reader->next) <= offset)
     {
-        static Error error = {CLI_STRTOBOOL, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        *errorptr = xmlFill(reader, offset + 1);
+        if (*errorptr || (size_t)(reader->limit - reader->next) <= offset)
+        {
+            return EOF;
+        }
     }
+    return (unsigned char)reader->next[offset];
+}
 
-    return value;
+// Check whether a byte is XML whitespace
+
+static bool
+xmlIsSpace(int c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
-// Convert an XML element's text to a double (call strtod with our own
-// error checking)
+// Check whether a byte ends an XML tag's name
 
-static double
-strtodnum(const char *numptr, const Error **errorptr)
+static bool
+xmlEndsName(int c)
 {
-    char *endptr = NULL;
+    return xmlIsSpace(c) || c == '/' || c == '>' || c == EOF;
+}
 
-    // Clear errno to detect error after calling strtod
-    errno = 0;
-    const double value = strtod(numptr, &endptr);
+// Consume bytes up to and including the given terminator
 
-    // Check for any errors converting the string to a number
-    if (errno != 0)
+static const Error *
+xmlSkipPast(XMLReader *reader, const char *terminator, size_t length)
+{
+    const Error *error = NULL;
+    while (!error)
     {
-        static Error error = {CLI_STRTOD_ERRNO, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        error = xmlFill(reader, length);
+        if (error) break;
+        if ((size_t)(reader->limit - reader->next) < length)
+        {
+            static const Error error_gone = {CLI_XML_GONE, {0}};
+            return &error_gone;
+        }
+
+        // Look for the terminator's first byte in the input buffer
+        const size_t searchable = (size_t)(reader->limit - reader->next) - length + 1;
+        char *       found = memchr(reader->next, terminator[0], searchable);
+        if (!found)
+        {
+            reader->next += searchable;
+        }
+        else if (memcmp(found, terminator, length) == 0)
+        {
+            reader->next = found + length;
+            return NULL;
+        }
+        else
+        {
+            reader->next = found + 1;
+        }
     }
-    else if (endptr == numptr)
+    return error;
+}
+
+// Consume a document type declaration, minding quoted strings and the
+// markup declarations, comments, and processing instructions inside
+// any internal subset, up to and including its closing '>'
+
+static const Error *
+xmlSkipDeclaration(XMLReader *reader)
+{
+    const Error *error = NULL;
+    int          quote = 0;
+    size_t       depth = 0;
+    reader->next += 2;
+    for (int c = xmlPeek(reader, 0, &error); c != EOF; c = xmlPeek(reader, 0, &error))
     {
-        static Error error = {CLI_STRTONUM_EMPTY, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        const int c1 = quote ? 0 : c == '<' ? xmlPeek(reader, 1, &error) : 0;
+        if (c1 == '!' && xmlPeek(reader, 2, &error) == '-' && xmlPeek(reader, 3, &error) == '-')
+        {
+            reader->next += 4;
+            error = xmlSkipPast(reader, "-->", 3);
+            if (error) return error;
+            continue;
+        }
+        if (c1 == '?')
+        {
+            reader->next += 2;
+            error = xmlSkipPast(reader, "?>", 2);
+            if (error) return error;
+            continue;
+        }
+
+        reader->next++;
+        if (quote)
+        {
+            quote = c == quote ? 0 : quote;
+        }
+        else if (c == '"' || c == '\'')
+        {
+            quote = c;
+        }
+        else if (c == '[')
+        {
+            depth++;
+        }
+        else if (c == ']' && depth)
+        {
+            depth--;
+        }
+        else if (c == '>' && !depth)
+        {
+            return NULL;
+        }
     }
-    else if (*endptr != '\0')
+
+    static const Error error_gone = {CLI_XML_GONE, {0}};
+    return error ? error : &error_gone;
+}
+
+// Consume whitespace, XML declarations, processing instructions,
+// comments, and document type declarations until the next start or
+// end tag (or the end of the stream)
+
+static const Error *
+xmlSkipMisc(XMLReader *reader)
+{
+    const Error *error = NULL;
+    while (!error)
     {
-        static Error error = {CLI_STRTONUM_NOT, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
-    }
+        int c = xmlPeek(reader, 0, &error);
+        if (xmlIsSpace(c))
+        {
+            reader->next++;
+            continue;
+        }
+        if (c != '<' || error)
+        {
+            break;
+        }
 
-    return value;
+        c = xmlPeek(reader, 1, &error);
+        if (c == '?')
+        {
+            error = xmlSkipPast(reader, "?>", 2);
+        }
+        else if (c == '!' && xmlPeek(reader, 2, &error) == '-' && xmlPeek(reader, 3, &error) == '-')
+        {
+            error = xmlSkipPast(reader, "-->", 3);
+        }
+        else if (c == '!')
+        {
+            error = xmlSkipDeclaration(reader);
+        }
+        else
+        {
+            break;
+        }
+    }
+    return error;
 }
 
-// Convert an XML element's text to a float (call strtof with our own
-// error checking)
+// Get pointer to error saying a name or text is too long for the
+// reader's buffers
 
-static float
-strtofnum(const char *numptr, const Error **errorptr)
+static const Error *
+xmlTooLong(XMLReader *reader)
 {
-    char *endptr = NULL;
+    Error *error = &reader->context->error;
+    error->code = CLI_XML_LONG;
+    error->arg.d64 = (int64_t)sizeof(reader->text) - 1;
+    return error;
+}
 
-    // Clear errno to detect error after calling strtof
-    errno = 0;
-    const float value = strtof(numptr, &endptr);
+// Consume a tag's name, copying it into the reader's name buffer and
+// hashing it the same way the code generator hashes ERD names
 
-    // Check for any errors converting the string to a number
-    if (errno != 0)
+static const Error *
+xmlReadName(XMLReader *reader)
+{
+    const Error *error = NULL;
+    size_t       length = 0;
+    uint32_t     hash = NAME_HASH_BASIS;
+    int          c = xmlPeek(reader, 0, &error);
+    while (!error && !xmlEndsName(c))
     {
-        static Error error = {CLI_STRTOD_ERRNO, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        if (length + 1 >= sizeof(reader->name))
+        {
+            return xmlTooLong(reader);
+        }
+        reader->name[length++] = (char)c;
+        hash = (hash ^ (uint8_t)c) * NAME_HASH_PRIME;
+        reader->next++;
+        c = xmlPeek(reader, 0, &error);
     }
-    else if (endptr == numptr)
+    reader->name[length] = 0;
+    reader->nameLength = length;
+    reader->nameHash = hash;
+    return error;
+}
+
+// Clear the reader's name buffer (leaves an empty name to mismatch)
+
+static void
+xmlClearName(XMLReader *reader)
+{
+    reader->name[0] = 0;
+    reader->nameLength = 0;
+    reader->nameHash = NAME_HASH_BASIS;
+}
+
+// Consume a start tag, skipping its attributes (sets empty if the tag
+// closes itself)
+
+static const Error *
+xmlReadStartTag(XMLReader *reader, bool *empty)
+{
+    const Error *error = xmlSkipMisc(reader);
+    if (error) return error;
+
+    // Check that we have a start tag (leaves an empty name to mismatch
+    // the caller's ERD if we have an end tag or text instead)
+    int c = xmlPeek(reader, 0, &error);
+    if (c != '<' || xmlPeek(reader, 1, &error) == '/')
     {
-        static Error error = {CLI_STRTONUM_EMPTY, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        static const Error error_gone = {CLI_XML_GONE, {0}};
+        xmlClearName(reader);
+        return error ? error : c == EOF ? &error_gone : NULL;
     }
-    else if (*endptr != '\0')
+    reader->next++;
+
+    error = xmlReadName(reader);
+    if (error) return error;
+
+    // Skip any attributes, minding quoted values
+    int quote = 0;
+    *empty = false;
+    for (c = xmlPeek(reader, 0, &error); c != EOF; c = xmlPeek(reader, 0, &error))
     {
-        static Error error = {CLI_STRTONUM_NOT, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        reader->next++;
+        if (quote)
+        {
+            quote = c == quote ? 0 : quote;
+        }
+        else if (c == '"' || c == '\'')
+        {
+            quote = c;
+        }
+        else if (c == '>')
+        {
+            return NULL;
+        }
+        else
+        {
+            *empty = c == '/';
+        }
     }
 
-    return value;
+    static const Error error_gone = {CLI_XML_GONE, {0}};
+    return error ? error : &error_gone;
 }
 
-// Convert an XML element's text to a signed integer (call strtoimax
-// with our own error checking)
+// Consume an end tag (leaves its name in the reader's name buffer)
 
-static intmax_t
-strtonum(const char *numptr, intmax_t minval, intmax_t maxval, const Error **errorptr)
+static const Error *
+xmlReadEndTag(XMLReader *reader)
 {
-    char *endptr = NULL;
-    assert(minval < maxval);
-
-    // Clear errno to detect error after calling strtoimax
-    errno = 0;
-    const intmax_t value = strtoimax(numptr, &endptr, 10);
+    const Error *error = xmlSkipMisc(reader);
+    if (error) return error;
 
-    // Check for any errors converting the string to a number
-    if (errno != 0)
+    // Check that we have an end tag
+    if (xmlPeek(reader, 0, &error) != '<' || xmlPeek(reader, 1, &error) != '/')
     {
-        static Error error = {CLI_STRTOI_ERRNO, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        static const Error error_gone = {CLI_XML_GONE, {0}};
+        return error ? error : &error_gone;
     }
-    else if (endptr == numptr)
+    reader->next += 2;
+
+    error = xmlReadName(reader);
+    int c = xmlPeek(reader, 0, &error);
+    while (!error && xmlIsSpace(c))
     {
-        static Error error = {CLI_STRTONUM_EMPTY, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        reader->next++;
+        c = xmlPeek(reader, 0, &error);
     }
-    else if (*endptr != '\0')
+    if (error) return error;
+    if (c != '>')
     {
-        static Error error = {CLI_STRTONUM_NOT, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        static const Error error_gone = {CLI_XML_GONE, {0}};
+        if (c == EOF) return &error_gone;
+
+        Error *error_syntax = &reader->context->error;
+        error_syntax->code = CLI_XML_SYNTAX;
+        error_syntax->arg.c = (char)c;
+        return error_syntax;
     }
-    else if (value < minval || value > maxval)
+    reader->next++;
+    return NULL;
+}
+
+// Append a byte to the reader's text buffer
+
+static const Error *
+xmlAppendText(XMLReader *reader, size_t *length, char c)
+{
+    if (*length + 1 >= sizeof(reader->text))
     {
-        static Error error = {CLI_STRTONUM_RANGE, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        return xmlTooLong(reader);
     }
-
-    return value;
+    reader->text[(*length)++] = c;
+    return NULL;
 }
 
-// Convert an XML element's text to an unsigned integer (call strtoumax
-// with our own error checking)
+// Decode a numeric character reference (&#N; or &#xN;) at the start of
+// the given bytes into UTF-8, returning how many bytes the reference
+// spans or 0 if it does not refer to a Unicode character
 
-static uintmax_t
-strtounum(const char *numptr, uintmax_t maxval, const Error **errorptr)
+static size_t
+xmlDecodeCharRef(const char *ref, size_t available, char utf8[4], size_t *utf8Length)
 {
-    char *endptr = NULL;
+    if (available < 4 || ref[0] != '&' || ref[1] != '#')
+    {
+        return 0;
+    }
 
-    // Clear errno to detect error after calling strtoumax
-    errno = 0;
-    const uintmax_t value = strtoumax(numptr, &endptr, 10);
+    // Accumulate the code point's digits up to the ';'
+    const bool   hex = ref[2] == 'x';
+    const size_t first = hex ? 3 : 2;
+    size_t       i = first;
+    uint32_t     cp = 0;
+    for (; i < available && ref[i] != ';'; i++)
+    {
+        const char c = ref[i];
+        uint32_t   digit;
+        if (c >= '0' && c <= '9')
+        {
+            digit = (uint32_t)(c - '0');
+        }
+        else if (hex && c >= 'a' && c <= 'f')
+        {
+            digit = (uint32_t)(c - 'a' + 10);
+        }
+        else if (hex && c >= 'A' && c <= 'F')
+        {
+            digit = (uint32_t)(c - 'A' + 10);
+        }
+        else
+        {
+            return 0;
+        }
+        cp = cp * (hex ? 16 : 10) + digit;
+        if (cp > 0x10FFFF) return 0;
+    }
+    if (i == first || i == available || cp == 0 || (cp >= 0xD800 && cp <= 0xDFFF))
+    {
+        return 0;
+    }
 
-    // Check for any errors converting the string to a number
-    if (errno != 0)
+    // Encode the code point as 1 to 4 UTF-8 bytes
+    if (cp < 0x80)
     {
-        static Error error = {CLI_STRTOI_ERRNO, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        utf8[0] = (char)cp;
+        *utf8Length = 1;
     }
-    else if (endptr == numptr)
+    else if (cp < 0x800)
     {
-        static Error error = {CLI_STRTONUM_EMPTY, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        utf8[0] = (char)(0xC0 | (cp >> 6));
+        utf8[1] = (char)(0x80 | (cp & 0x3F));
+        *utf8Length = 2;
     }
-    else if (*endptr != '\0')
+    else if (cp < 0x10000)
     {
-        static Error error = {CLI_STRTONUM_NOT, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        utf8[0] = (char)(0xE0 | (cp >> 12));
+        utf8[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (cp & 0x3F));
+        *utf8Length = 3;
     }
-    else if (value > maxval)
+    else
     {
-        static Error error = {CLI_STRTONUM_RANGE, {0}};
-        error.arg.s = numptr;
-        *errorptr = &error;
+        utf8[0] = (char)(0xF0 | (cp >> 18));
+        utf8[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (cp & 0x3F));
+        *utf8Length = 4;
     }
-
-    return value;
+    return i + 1;
 }
 
-// Read XML data from file before walking infoset
+// Consume a predefined entity or numeric character reference and
+// append the character it stands for to the reader's text buffer
+// (appends a lone '&' as itself if neither follows it)
 
 static const Error *
-xmlStartDocument(XMLReader *reader)
+xmlReadReference(XMLReader *reader, size_t *length)
 {
-    // Load the XML data into memory
-    reader->xml = mxmlLoadFile(NULL, reader->stream, MXML_OPAQUE_CALLBACK);
-    reader->node = reader->xml;
-    if (!reader->node)
+    static const struct
     {
-        static Error error = {CLI_XML_INPUT, {0}};
-        return &error;
-    }
-
-    // Consume the <?xml line if there is one
-    const char *name = mxmlGetElement(reader->node);
-    if (name && strncmp(name, "?xml", strlen("?xml")) == 0)
+        const char *entity;
+        size_t      length;
+        char        c;
+    } entities[] = {
+        {"&lt;", 4, '<'}, {"&gt;", 4, '>'}, {"&amp;", 5, '&'}, {"&quot;", 6, '"'}, {"&apos;", 6, '\''},
+    };
+
+    // Make sure the longest reference we decode is in the input buffer
+    // ("&#x0010FFFF;" with a few leading zeros)
+    const Error *error = xmlFill(reader, 16);
+    if (error) return error;
+    const size_t unread = (size_t)(reader->limit - reader->next);
+
+    for (size_t i = 0; i < sizeof(entities) / sizeof(entities[0]); i++)
     {
-        do
+        const size_t entity_length = entities[i].length;
+        if (unread >= entity_length && memcmp(reader->next, entities[i].entity, entity_length) == 0)
         {
-            reader->node = mxmlWalkNext(reader->node, reader->xml, MXML_DESCEND);
-        } while (mxmlGetType(reader->node) == MXML_OPAQUE);
-        name = mxmlGetElement(reader->node);
+            reader->next += entity_length;
+            return xmlAppendText(reader, length, entities[i].c);
+        }
     }
 
-    // Consume a comment if there is one
-    if (name && strncmp(name, "!--", strlen("!--")) == 0)
+    char         utf8[4];
+    size_t       utf8Length = 0;
+    const size_t consumed = xmlDecodeCharRef(reader->next, unread, utf8, &utf8Length);
+    if (consumed)
     {
-        do
+        reader->next += consumed;
+        for (size_t i = 0; i < utf8Length && !error; i++)
         {
-            reader->node = mxmlWalkNext(reader->node, reader->xml, MXML_DESCEND);
-        } while (mxmlGetType(reader->node) == MXML_OPAQUE);
+            error = xmlAppendText(reader, length, utf8[i]);
+        }
+        return error;
     }
 
-    static Error error = {CLI_XML_GONE, {0}};
-    return reader->node ? NULL : &error;
+    reader->next++;
+    return xmlAppendText(reader, length, '&');
 }
 
-// Delete XML data after walking infoset
+// Consume a CDATA section's contents and closing "]]>", appending its
+// contents to the reader's text buffer as they are
 
 static const Error *
-xmlEndDocument(XMLReader *reader)
+xmlReadCData(XMLReader *reader, size_t *length)
 {
-    // Consume any remaining newlines or whitespace
-    while (mxmlGetType(reader->node) == MXML_OPAQUE)
+    const Error *error = NULL;
+    while (!error)
     {
-        reader->node = mxmlWalkNext(reader->node, reader->xml, MXML_DESCEND);
+        error = xmlFill(reader, 3);
+        if (error) break;
+        if ((size_t)(reader->limit - reader->next) < 3)
+        {
+            static const Error error_gone = {CLI_XML_GONE, {0}};
+            return &error_gone;
+        }
+        if (memcmp(reader->next, "]]>", 3) == 0)
+        {
+            reader->next += 3;
+            break;
+        }
+        error = xmlAppendText(reader, length, *reader->next++);
     }
+    return error;
+}
 
-    // Check whether we have consumed all of the XML data
-    if (reader->node)
+// Consume an element's text and copy it into the reader's text buffer
+// (replaces predefined entities and numeric character references with
+// the characters they stand for, copies CDATA sections as they are,
+// and skips comments and processing instructions)
+
+static const Error *
+xmlReadText(XMLReader *reader)
+{
+    const Error *error = NULL;
+    size_t       length = 0;
+    int          c = xmlPeek(reader, 0, &error);
+    while (!error && c != EOF)
     {
-        // This code path exits the program - no need to call mxmlDelete
-        static Error error = {CLI_XML_LEFT, {0}};
-        error.arg.s = mxmlGetElement(reader->node);
-        return &error;
+        if (c == '<')
+        {
+            // Stop at the end tag, or consume whichever markup can
+            // appear inside text
+            error = xmlFill(reader, 9);
+            const size_t unread = (size_t)(reader->limit - reader->next);
+            if (error)
+            {
+                break;
+            }
+            else if (unread >= 9 && memcmp(reader->next, "<![CDATA[", 9) == 0)
+            {
+                reader->next += 9;
+                error = xmlReadCData(reader, &length);
+            }
+            else if (unread >= 4 && memcmp(reader->next, "<!--", 4) == 0)
+            {
+                reader->next += 4;
+                error = xmlSkipPast(reader, "-->", 3);
+            }
+            else if (unread >= 2 && reader->next[1] == '?')
+            {
+                reader->next += 2;
+                error = xmlSkipPast(reader, "?>", 2);
+            }
+            else
+            {
+                break;
+            }
+        }
+        else if (c == '&')
+        {
+            error = xmlReadReference(reader, &length);
+        }
+        else
+        {
+            reader->next++;
+            error = xmlAppendText(reader, &length, (char)c);
+        }
+        if (!error)
+        {
+            c = xmlPeek(reader, 0, &error);
+        }
     }
+    reader->text[length] = 0;
+    return error;
+}
 
-    // Free the storage allocated to hold the XML data
-    mxmlDelete(reader->xml);
-    reader->xml = NULL;
-    reader->node = NULL;
-    return NULL;
+// Start reading XML data from the stream
+
+static const Error *
+xmlStartDocument(XMLReader *reader)
+{
+    reader->next = reader->block;
+    reader->limit = reader->block;
+    reader->empty = false;
+
+    // Consume the <?xml line and any comments before the root element
+    const Error *error = xmlSkipMisc(reader);
+    if (!error && xmlPeek(reader, 0, &error) == EOF && !error)
+    {
+        static const Error error_gone = {CLI_XML_GONE, {0}};
+        return &error_gone;
+    }
+    return error;
 }
 
-// Continue walking both XML data and infoset in lockstep
+// Check that we have consumed all of the XML data
 
 static const Error *
-xmlStartComplex(XMLReader *reader, const InfosetBase *base)
+xmlEndDocument(XMLReader *reader)
 {
-    // Consume any newlines or whitespace before the element
-    while (mxmlGetType(reader->node) == MXML_OPAQUE)
+    // Consume any remaining newlines, whitespace, or comments
+    const Error *error = xmlSkipMisc(reader);
+    if (!error && xmlPeek(reader, 0, &error) != EOF)
     {
-        reader->node = mxmlWalkNext(reader->node, reader->xml, MXML_DESCEND);
+        // Tell which element is left if we can
+        bool empty = false;
+        xmlClearName(reader);
+        if (!error && xmlPeek(reader, 1, &error) == '/')
+        {
+            error = xmlReadEndTag(reader);
+        }
+        else if (!error)
+        {
+            error = xmlReadStartTag(reader, &empty);
+        }
+
+        Error *error_left = &reader->context->error;
+        error_left->code = CLI_XML_LEFT;
+        error_left->arg.s = reader->name;
+        return error_left;
     }
+    return error;
+}
 
-    // Get the element and consume it
-    const char *name_from_xml = mxmlGetElement(reader->node);
-    const char *name_from_erd = get_erd_name(base->erd);
-    reader->node = mxmlWalkNext(reader->node, reader->xml, MXML_DESCEND);
+// Check that an element's start or end tag matches its ERD
 
-    // Check whether we are walking both XML data and infoset in lockstep
-    if (name_from_xml && name_from_erd)
+static const Error *
+xmlCheckName(XMLReader *reader, const ERD *erd)
+{
+    // Compare hashes and lengths first so most mismatches cost only an
+    // integer compare, then confirm that the bytes match too
+    const NamedQName *qname = &erd->namedQName;
+    if (reader->nameHash != qname->nameHash || reader->nameLength != qname->nameLength ||
+        memcmp(reader->name, qname->name, qname->nameLength) != 0)
     {
-        static Error error = {CLI_XML_MISMATCH, {0}};
-        error.arg.s = name_from_erd;
-        return strcmp(name_from_xml, name_from_erd) == 0 ? NULL : &error;
+        Error *error = &reader->context->error;
+        error->code = CLI_XML_MISMATCH;
+        error->arg.s = qname->name;
+        return error;
     }
-    else
+    return NULL;
+}
+
+// Continue walking both XML data and infoset in lockstep
+
+static const Error *
+xmlStartComplex(XMLReader *reader, const InfosetBase *base)
+{
+    bool         empty = false;
+    const Error *error = xmlReadStartTag(reader, &empty);
+    if (!error)
     {
-        static Error error = {CLI_XML_GONE, {0}};
-        return &error;
+        error = xmlCheckName(reader, base->erd);
     }
+    reader->empty = empty;
+    return error;
 }
 
-// Consume XML data only on start events, not end events
+// Consume a complex element's end tag unless its start tag closed itself
 
 static const Error *
 xmlEndComplex(XMLReader *reader, const InfosetBase *base)
 {
-    UNUSED(reader); // because nothing to read
-    UNUSED(base);   // because nothing to check
-    return NULL;
+    if (reader->empty)
+    {
+        reader->empty = false;
+        return NULL;
+    }
+
+    const Error *error = xmlReadEndTag(reader);
+    if (!error)
+    {
+        error = xmlCheckName(reader, base->erd);
+    }
+    return error;
 }
 
 // Read a boolean, 32-bit or 64-bit real number, or 8, 16, 32, or
@@ -328,83 +694,37 @@ xmlEndComplex(XMLReader *reader, const InfosetBase *base)
 static const Error *
 xmlNumberElem(XMLReader *reader, const ERD *erd, void *number)
 {
-    // Consume any newlines or whitespace before the element
-    while (mxmlGetType(reader->node) == MXML_OPAQUE)
+    // Consume the element's start tag, text, and end tag
+    bool         empty = false;
+    const Error *error = xmlReadStartTag(reader, &empty);
+    if (!error)
     {
-        reader->node = mxmlWalkNext(reader->node, reader->xml, MXML_DESCEND);
+        error = xmlCheckName(reader, erd);
     }
-
-    // Get the element and consume it
-    const char *name_from_xml = mxmlGetElement(reader->node);
-    const char *name_from_erd = get_erd_name(erd);
-    const char *number_from_xml = mxmlGetOpaque(reader->node);
-    reader->node = mxmlWalkNext(reader->node, reader->xml, MXML_DESCEND);
-
-    // Check whether we are walking both XML data and infoset in lockstep
-    if (name_from_xml && name_from_erd)
+    if (!error && !empty)
     {
-        if (strcmp(name_from_xml, name_from_erd) == 0)
+        error = xmlReadText(reader);
+        if (!error)
         {
-            // Check for any errors getting the number
-            const Error *error = NULL;
-
-            // Handle varying bit lengths of both signed & unsigned numbers
-            const enum TypeCode typeCode = erd->typeCode;
-            switch (typeCode)
-            {
-            case PRIMITIVE_BOOLEAN:
-                *(bool *)number = strtobool(number_from_xml, &error);
-                return error;
-            case PRIMITIVE_FLOAT:
-                *(float *)number = strtofnum(number_from_xml, &error);
-                return error;
-            case PRIMITIVE_DOUBLE:
-                *(double *)number = strtodnum(number_from_xml, &error);
-                return error;
-            case PRIMITIVE_INT16:
-                *(int16_t *)number = (int16_t)strtonum(number_from_xml, INT16_MIN, INT16_MAX, &error);
-                return error;
-            case PRIMITIVE_INT32:
-                *(int32_t *)number = (int32_t)strtonum(number_from_xml, INT32_MIN, INT32_MAX, &error);
-                return error;
-            case PRIMITIVE_INT64:
-                *(int64_t *)number = (int64_t)strtonum(number_from_xml, INT64_MIN, INT64_MAX, &error);
-                return error;
-            case PRIMITIVE_INT8:
-                *(int8_t *)number = (int8_t)strtonum(number_from_xml, INT8_MIN, INT8_MAX, &error);
-                return error;
-            case PRIMITIVE_UINT16:
-                *(uint16_t *)number = (uint16_t)strtounum(number_from_xml, UINT16_MAX, &error);
-                return error;
-            case PRIMITIVE_UINT32:
-                *(uint32_t *)number = (uint32_t)strtounum(number_from_xml, UINT32_MAX, &error);
-                return error;
-            case PRIMITIVE_UINT64:
-                *(uint64_t *)number = (uint64_t)strtounum(number_from_xml, UINT64_MAX, &error);
-                return error;
-            case PRIMITIVE_UINT8:
-                *(uint8_t *)number = (uint8_t)strtounum(number_from_xml, UINT8_MAX, &error);
-                return error;
-            default:
-            {
-                static Error error_erd = {CLI_XML_ERD, {0}};
-                error_erd.arg.d64 = typeCode;
-                return &error_erd;
-            }
-            }
+            error = xmlReadEndTag(reader);
         }
-        else
+        if (!error)
         {
-            static Error error = {CLI_XML_MISMATCH, {0}};
-            error.arg.s = name_from_erd;
-            return &error;
+            error = xmlCheckName(reader, erd);
         }
     }
     else
     {
-        static Error error = {CLI_XML_GONE, {0}};
-        return &error;
+        reader->text[0] = 0;
     }
+    if (error)
+    {
+        return error;
+    }
+
+    // Convert the text to the element's boolean or number type
+    const NumberParse result = parse_number(erd->typeCode, reader->text, number);
+    return number_error(result, erd->typeCode, reader->text, &reader->context->error);
 }
 
 // Initialize a struct with our visitor event handler methods
@@ -412,5 +732,5 @@ xmlNumberElem(XMLReader *reader, const ERD *erd, void *number)
 const VisitEventHandler xmlReaderMethods = {
     (VisitStartDocument)&xmlStartDocument, (VisitEndDocument)&xmlEndDocument,
     (VisitStartComplex)&xmlStartComplex,   (VisitEndComplex)&xmlEndComplex,
-    (VisitNumberElem)&xmlNumberElem,
+    (VisitNumberElem)&xmlNumberElem,       NULL,
 };
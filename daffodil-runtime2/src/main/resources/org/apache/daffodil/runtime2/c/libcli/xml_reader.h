@@ -19,20 +19,33 @@
 #define XML_READER_H
 
 // clang-format off
-#include <mxml.h>     // for mxml_node_t
+#include <stdbool.h>  // for bool
+#include <stddef.h>   // for size_t
+#include <stdint.h>   // for uint32_t
 #include <stdio.h>    // for FILE
-#include "infoset.h"  // for VisitEventHandler, InfosetBase
+#include "errors.h"   // for LIMIT_BLOCK_SIZE, LIMIT_NAME_LENGTH
+#include "infoset.h"  // for VisitEventHandler, RuntimeContext
 // clang-format on
 
-// XMLReader - infoset visitor with methods to read XML
+// XMLReader - infoset visitor with methods to read XML (reads XML from
+// the stream into its input buffer only as it visits the infoset and
+// consumes each tag on demand, using the same memory regardless of
+// how much XML data the stream holds; walking the reader still reads
+// the whole document into the infoset before unparsing can start)
 
 typedef struct XMLReader
 {
     const VisitEventHandler handler;
     FILE *                  stream;
-    InfosetBase *           root;
-    mxml_node_t *           xml;
-    mxml_node_t *           node;
+    RuntimeContext *        context;
+    char *                  next;                     // next unread byte in input buffer
+    char *                  limit;                    // one past last unread byte in input buffer
+    bool                    empty;                    // whether last start tag closed itself
+    size_t                  nameLength;               // length of last tag's name
+    uint32_t                nameHash;                 // FNV-1a hash of last tag's name
+    char                    name[LIMIT_NAME_LENGTH];  // name of last tag read
+    char                    text[LIMIT_NAME_LENGTH];  // text of last simple element read
+    char                    block[LIMIT_BLOCK_SIZE];  // input buffer's storage
 } XMLReader;
 
 // XMLReader methods to pass to walkInfoset method
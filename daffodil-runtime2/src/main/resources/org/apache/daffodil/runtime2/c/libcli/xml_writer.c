@@ -17,186 +17,321 @@
 
 // clang-format off
 #include "xml_writer.h"
-#include <assert.h>      // for assert
-#include <mxml.h>        // for mxmlNewOpaquef, mxml_node_t, mxmlElementSetAttr, mxmlGetOpaque, mxmlNewElement, mxmlDelete, mxmlGetElement, mxmlNewXML, mxmlSaveFile, MXML_NO_CALLBACK
-#include <stdbool.h>     // for bool
-#include <stdint.h>      // for int16_t, int32_t, int64_t, int8_t, uint16_t, uint32_t, uint64_t, uint8_t
-#include <string.h>      // for strcmp
-#include "cli_errors.h"  // for CLI_XML_DECL, CLI_XML_ELEMENT, CLI_XML_WRITE, LIMIT_XML_NESTING
-#include "errors.h"      // for Error, Error::(anonymous)
-#include "stack.h"       // for stack_is_empty, stack_pop, stack_push, stack_top, stack_init
+#include <stdbool.h>      // for bool
+#include <stdint.h>       // for int16_t, int32_t, int64_t, int8_t, uint16_t, uint32_t, uint64_t, uint8_t
+#include <stdio.h>        // for fwrite
+#include <string.h>       // for memcpy, strlen, strcspn
+#include "cli_errors.h"   // for CLI_XML_WRITE
+#include "errors.h"       // for Error
+#include "number_text.h"  // for format_int64, format_uint64, format_double, format_float, format_number, LIMIT_NUMBER_TEXT
 // clang-format on
 
-// Push new XML document on stack (note the stack is stored in a
-// static array which could overflow and stop the program; it also
-// means none of those functions are thread-safe)
+// Write the output buffer's bytes to the stream, emptying the buffer
 
 static const Error *
-xmlStartDocument(XMLWriter *writer)
+xmlFlush(XMLWriter *writer)
 {
-    static mxml_node_t *array[LIMIT_XML_NESTING];
-    stack_init(&writer->stack, array, LIMIT_XML_NESTING);
-
-    mxml_node_t *xml = mxmlNewXML("1.0");
-    if (xml)
+    const size_t length = (size_t)(writer->next - writer->block);
+    const size_t count = fwrite(writer->block, 1, length, writer->stream);
+    writer->next = writer->block;
+    if (count < length)
     {
-        stack_push(&writer->stack, xml);
-        return NULL;
+        static const Error error = {CLI_XML_WRITE, {0}};
+        return &error;
     }
-    else
+    return NULL;
+}
+
+// Write bytes into the output buffer, flushing it whenever it fills up
+
+static const Error *
+xmlWrite(XMLWriter *writer, const char *bytes, size_t length)
+{
+    while (length)
     {
-        static Error error = {CLI_XML_DECL, {0}};
-        return &error;
+        size_t room = (size_t)(writer->block + sizeof(writer->block) - writer->next);
+        if (!room)
+        {
+            const Error *error = xmlFlush(writer);
+            if (error) return error;
+            room = sizeof(writer->block);
+        }
+
+        const size_t count = length < room ? length : room;
+        memcpy(writer->next, bytes, count);
+        writer->next += count;
+        bytes += count;
+        length -= count;
     }
+    return NULL;
 }
 
-// Pop completed XML document off stack and write it to stream (note
-// stack underflow will stop program)
+// Write a string into the output buffer
 
 static const Error *
-xmlEndDocument(XMLWriter *writer)
+xmlWriteString(XMLWriter *writer, const char *string)
 {
-    mxml_node_t *xml = stack_pop(&writer->stack);
-    assert(stack_is_empty(&writer->stack));
+    return xmlWrite(writer, string, strlen(string));
+}
+
+// Write a string into the output buffer, escaping any characters
+// which can't appear literally in attribute values or text
 
-    int status = mxmlSaveFile(xml, writer->stream, MXML_NO_CALLBACK);
-    if (status < 0)
+static const Error *
+xmlWriteEscaped(XMLWriter *writer, const char *string)
+{
+    const Error *error = NULL;
+    while (*string && !error)
     {
-        static Error error = {CLI_XML_WRITE, {0}};
-        return &error;
+        // Write the longest run of characters needing no escapes at once
+        const size_t run = strcspn(string, "<>&\"'");
+        error = xmlWrite(writer, string, run);
+        string += run;
+        if (!error && *string)
+        {
+            switch (*string)
+            {
+            case '<':
+                error = xmlWriteString(writer, "&lt;");
+                break;
+            case '>':
+                error = xmlWriteString(writer, "&gt;");
+                break;
+            case '&':
+                error = xmlWriteString(writer, "&amp;");
+                break;
+            case '"':
+                error = xmlWriteString(writer, "&quot;");
+                break;
+            default:
+                error = xmlWriteString(writer, "&apos;");
+                break;
+            }
+            string++;
+        }
     }
-    mxmlDelete(xml);
-    return NULL;
+    return error;
 }
 
-// Push new complex element on stack (note stack overflow will stop
-// program)
+// Write an element's start tag with any namespace declaration it needs
 
 static const Error *
-xmlStartComplex(XMLWriter *writer, const InfosetBase *base)
+xmlWriteStartTag(XMLWriter *writer, const ERD *erd)
 {
-    mxml_node_t *parent = stack_top(&writer->stack);
-    const char * name = get_erd_name(base->erd);
-    const char * xmlns = get_erd_xmlns(base->erd);
-    mxml_node_t *complex = mxmlNewElement(parent, name);
-    if (xmlns)
+    const NamedQName *qname = &erd->namedQName;
+    const Error *     error = xmlWrite(writer, "<", 1);
+    if (!error)
     {
-        const char *ns = get_erd_ns(base->erd);
-        mxmlElementSetAttr(complex, xmlns, ns);
+        error = xmlWrite(writer, qname->name, qname->nameLength);
     }
-    stack_push(&writer->stack, complex);
-    return NULL;
+
+    if (qname->xmlns && !error)
+    {
+        error = xmlWrite(writer, " ", 1);
+        if (!error)
+        {
+            error = xmlWriteString(writer, qname->xmlns);
+        }
+        if (!error)
+        {
+            error = xmlWrite(writer, "=\"", 2);
+        }
+        if (!error)
+        {
+            error = xmlWriteEscaped(writer, qname->ns);
+        }
+        if (!error)
+        {
+            error = xmlWrite(writer, "\"", 1);
+        }
+    }
+
+    if (!error)
+    {
+        error = xmlWrite(writer, ">", 1);
+    }
+    return error;
 }
 
-// Pop completed complex element off stack (note stack underflow will
-// stop program)
+// Write an element's end tag
 
 static const Error *
-xmlEndComplex(XMLWriter *writer, const InfosetBase *base)
+xmlWriteEndTag(XMLWriter *writer, const ERD *erd)
 {
-    mxml_node_t *complex = stack_pop(&writer->stack);
+    const Error *error = xmlWrite(writer, "</", 2);
+    if (!error)
+    {
+        error = xmlWrite(writer, erd->namedQName.name, erd->namedQName.nameLength);
+    }
+    if (!error)
+    {
+        error = xmlWrite(writer, ">", 1);
+    }
+    return error;
+}
 
-    const char *name_from_xml = mxmlGetElement(complex);
-    const char *name_from_erd = get_erd_name(base->erd);
-    assert(strcmp(name_from_xml, name_from_erd) == 0);
+// Start a new XML document with an XML declaration
 
-    return NULL;
+static const Error *
+xmlStartDocument(XMLWriter *writer)
+{
+    writer->next = writer->block;
+    return xmlWriteString(writer, "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n");
 }
 
-// Fix a real number to conform to xsd:float syntax if needed
+// End the XML document and write the rest of it to the stream
 
-static void
-fixNumberIfNeeded(const char *text)
+static const Error *
+xmlEndDocument(XMLWriter *writer)
 {
-    if (text[0] == 'N' && text[1] == 'A')
+    const Error *error = xmlWrite(writer, "\n", 1);
+    if (!error)
     {
-        // xsd:float requires NaN to be capitalized correctly
-        char *modifyInPlace = (char *)text;
-        modifyInPlace[1] = 'a';
+        error = xmlFlush(writer);
     }
-    // We aren't writing code to remove all textual differences
-    // between runtime1/runtime2 because it would be better to make
-    // Daffodil compare numbers numerically, not textually.  If we did
-    // have to match runtime1 perfectly, we would have to:
-    //  - Strip + from <f>E+<e> to get <f>E<e>
-    //  - Add .0 to 1 to get 1.0
-    //  - Change number of significant digits to match runtime1
+    return error;
 }
 
-// Write a boolean, 32-bit or 64-bit real number, or 8, 16, 32, or
-// 64-bit signed or unsigned integer as an XML element's value
+// Write a complex element's start tag
 
 static const Error *
-xmlNumberElem(XMLWriter *writer, const ERD *erd, const void *number)
+xmlStartComplex(XMLWriter *writer, const InfosetBase *base)
+{
+    return xmlWriteStartTag(writer, base->erd);
+}
+
+// Write a complex element's end tag
+
+static const Error *
+xmlEndComplex(XMLWriter *writer, const InfosetBase *base)
 {
-    mxml_node_t *parent = stack_top(&writer->stack);
-    const char * name = get_erd_name(erd);
-    mxml_node_t *simple = mxmlNewElement(parent, name);
+    return xmlWriteEndTag(writer, base->erd);
+}
 
-    // Set namespace declaration if necessary
-    const char *xmlns = get_erd_xmlns(erd);
-    if (xmlns)
+// Write a simple element with its already formatted text
+
+static const Error *
+xmlWriteSimple(XMLWriter *writer, const ERD *erd, const char *text, size_t length)
+{
+    const Error *error = xmlWriteStartTag(writer, erd);
+    if (!error && length > 0)
+    {
+        error = xmlWrite(writer, text, length);
+    }
+    if (!error)
     {
-        const char *ns = get_erd_ns(erd);
-        mxmlElementSetAttr(simple, xmlns, ns);
+        error = xmlWriteEndTag(writer, erd);
     }
+    return error;
+}
+
+// Write a number as an XML element's value
+
+static const Error *
+xmlNumberElem(XMLWriter *writer, const ERD *erd, const void *number)
+{
+    char         text[LIMIT_NUMBER_TEXT];
+    const size_t length = format_number(erd->typeCode, number, text);
+    return xmlWriteSimple(writer, erd, text, length);
+}
 
-    // Handle varying bit lengths of both signed & unsigned numbers
-    const enum TypeCode typeCode = erd->typeCode;
-    mxml_node_t *       text = NULL;
-    switch (typeCode)
+// Write a run of adjacent numbers of the same type as XML elements'
+// values, switching on their type only once for the whole run
+
+static const Error *
+xmlNumberRun(XMLWriter *writer, const ERD *const *erds, const void *numbers, size_t count)
+{
+    char         text[LIMIT_NUMBER_TEXT];
+    const Error *error = NULL;
+    size_t       size = 0;
+    size_t       i;
+    switch (erds[0]->typeCode)
     {
-    case PRIMITIVE_BOOLEAN:
-        text = mxmlNewOpaquef(simple, "%s", *(const bool *)number ? "true" : "false");
-        break;
-    case PRIMITIVE_FLOAT:
-        // Round-trippable float, shortest possible
-        text = mxmlNewOpaquef(simple, "%.9G", *(const float *)number);
-        fixNumberIfNeeded(mxmlGetOpaque(text));
-        break;
     case PRIMITIVE_DOUBLE:
-        // Round-trippable double, shortest possible
-        text = mxmlNewOpaquef(simple, "%.17lG", *(const double *)number);
-        fixNumberIfNeeded(mxmlGetOpaque(text));
-        break;
-    case PRIMITIVE_INT16:
-        text = mxmlNewOpaquef(simple, "%hi", *(const int16_t *)number);
-        break;
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_double(((const double *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
+    case PRIMITIVE_FLOAT:
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_float(((const float *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
     case PRIMITIVE_INT32:
-        text = mxmlNewOpaquef(simple, "%i", *(const int32_t *)number);
-        break;
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_int64(((const int32_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
     case PRIMITIVE_INT64:
-        text = mxmlNewOpaquef(simple, "%li", *(const int64_t *)number);
-        break;
-    case PRIMITIVE_INT8:
-        text = mxmlNewOpaquef(simple, "%hhi", *(const int8_t *)number);
-        break;
-    case PRIMITIVE_UINT16:
-        text = mxmlNewOpaquef(simple, "%hu", *(const uint16_t *)number);
-        break;
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_int64(((const int64_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
     case PRIMITIVE_UINT32:
-        text = mxmlNewOpaquef(simple, "%u", *(const uint32_t *)number);
-        break;
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_uint64(((const uint32_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
     case PRIMITIVE_UINT64:
-        text = mxmlNewOpaquef(simple, "%lu", *(const uint64_t *)number);
-        break;
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_uint64(((const uint64_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
+    case PRIMITIVE_BOOLEAN:
+        for (i = 0; i < count && !error; i++)
+        {
+            const bool value = ((const bool *)numbers)[i];
+            error = xmlWriteSimple(writer, erds[i], value ? "true" : "false", value ? 4 : 5);
+        }
+        return error;
+    case PRIMITIVE_INT8:
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_int64(((const int8_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
+    case PRIMITIVE_INT16:
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_int64(((const int16_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
     case PRIMITIVE_UINT8:
-        text = mxmlNewOpaquef(simple, "%hhu", *(const uint8_t *)number);
-        break;
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_uint64(((const uint8_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
+    case PRIMITIVE_UINT16:
+        for (i = 0; i < count && !error; i++)
+        {
+            const size_t length = format_uint64(((const uint16_t *)numbers)[i], text);
+            error = xmlWriteSimple(writer, erds[i], text, length);
+        }
+        return error;
     default:
-        // Let text remain NULL and report error below
-        break;
-    }
-
-    if (simple && text)
-    {
-        return NULL;
-    }
-    else
-    {
-        static Error error = {CLI_XML_ELEMENT, {0}};
-        error.arg.s = name;
-        return &error;
+        // Runs hold only numbers, so write any other type one at a time
+        size = numberSize(erds[0]->typeCode);
+        for (i = 0; i < count && !error; i++)
+        {
+            error = xmlNumberElem(writer, erds[i], (const char *)numbers + i * size);
+        }
+        return error;
     }
 }
 
@@ -205,5 +340,5 @@ xmlNumberElem(XMLWriter *writer, const ERD *erd, const void *number)
 const VisitEventHandler xmlWriterMethods = {
     (VisitStartDocument)&xmlStartDocument, (VisitEndDocument)&xmlEndDocument,
     (VisitStartComplex)&xmlStartComplex,   (VisitEndComplex)&xmlEndComplex,
-    (VisitNumberElem)&xmlNumberElem,
+    (VisitNumberElem)&xmlNumberElem,       (VisitNumberRun)&xmlNumberRun,
 };
@@ -20,17 +20,22 @@
 
 // clang-format off
 #include <stdio.h>    // for FILE
-#include "infoset.h"  // for VisitEventHandler
-#include "stack.h"    // for stack_t
+#include "errors.h"   // for LIMIT_BLOCK_SIZE
+#include "infoset.h"  // for VisitEventHandler, RuntimeContext
 // clang-format on
 
-// XMLWriter - infoset visitor with methods to output XML
+// XMLWriter - infoset visitor with methods to output XML (writes XML
+// into its output buffer as it visits the infoset and writes the
+// output buffer to the stream only when the buffer fills up or the
+// document ends, using the same memory regardless of infoset size)
 
 typedef struct XMLWriter
 {
     const VisitEventHandler handler;
     FILE *                  stream;
-    stack_t                 stack;
+    RuntimeContext *        context;
+    char *                  next;                    // next unwritten byte in output buffer
+    char                    block[LIMIT_BLOCK_SIZE]; // output buffer's storage
 } XMLWriter;
 
 // XMLWriter methods to pass to walkInfoset method
@@ -22,6 +22,7 @@
 #include <stdbool.h>   // for bool, false, true
 #include <stdio.h>     // for fprintf, stderr, feof, ferror, FILE, stdout
 #include <stdlib.h>    // for exit, EXIT_FAILURE, EXIT_SUCCESS
+#include <string.h>    // for memmove, strnlen
 // clang-format oon
 
 // eof_or_error - get pointer to error if stream has eof or error indicator set
@@ -31,12 +32,12 @@ eof_or_error(FILE *stream)
 {
     if (feof(stream))
     {
-        static Error error = {ERR_STREAM_EOF, {0}};
+        static const Error error = {ERR_STREAM_EOF, {0}};
         return &error;
     }
     else if (ferror(stream))
     {
-        static Error error = {ERR_STREAM_ERROR, {0}};
+        static const Error error = {ERR_STREAM_ERROR, {0}};
         return &error;
     }
     else
@@ -45,15 +46,6 @@ eof_or_error(FILE *stream)
     }
 }
 
-// get_diagnostics - get pointer to validation diagnostics
-
-Diagnostics *
-get_diagnostics(void)
-{
-    static Diagnostics diagnostics;
-    return &diagnostics;
-}
-
 // add_diagnostic - add a new error to validation diagnostics
 
 bool
@@ -100,38 +92,77 @@ error_lookup(uint8_t code)
     }
 }
 
-// print_maybe_stop - print a message and maybe stop the program
+// lookup_any_error - look up a libruntime or CLI error message
 
-static void
-print_maybe_stop(const Error *error, int status)
+static const ErrorLookup *
+lookup_any_error(uint8_t code)
 {
-    const ErrorLookup *lookup = error_lookup(error->code);
+    const ErrorLookup *lookup = error_lookup(code);
     if (!lookup && cli_error_lookup)
     {
-        lookup = cli_error_lookup(error->code);
+        lookup = cli_error_lookup(code);
     }
     assert(lookup);
+    return lookup;
+}
+
+// copy_error - copy an error into storage which outlives the error's
+// source, copying its string argument (if it has one) into text
+
+const Error *
+copy_error(Error *copy, char *text, size_t capacity, const Error *error)
+{
+    const ErrorLookup *lookup = lookup_any_error(error->code);
+    *copy = *error;
+    if ((lookup->field == FIELD_S || lookup->field == FIELD_S_ON_STDOUT) && error->arg.s && capacity)
+    {
+        // The argument may already live in text, so move it
+        const size_t length = strnlen(error->arg.s, capacity - 1);
+        memmove(text, error->arg.s, length);
+        text[length] = '\0';
+        copy->arg.s = text;
+    }
+    return copy;
+}
+
+// fprint_error - print an error's message to a stream
+
+void
+fprint_error(FILE *stream, const Error *error)
+{
+    const ErrorLookup *lookup = lookup_any_error(error->code);
 
     switch (lookup->field)
     {
     case FIELD_C:
-        fprintf(stderr, lookup->message, error->arg.c);
+        fprintf(stream, lookup->message, error->arg.c);
         break;
     case FIELD_D64:
-        fprintf(stderr, lookup->message, error->arg.d64);
+        fprintf(stream, lookup->message, error->arg.d64);
         break;
     case FIELD_S:
-        fprintf(stderr, lookup->message, error->arg.s);
-        break;
     case FIELD_S_ON_STDOUT:
-        fprintf(stdout, lookup->message, error->arg.s);
-        exit(EXIT_SUCCESS);
+        fprintf(stream, lookup->message, error->arg.s);
         break;
     case FIELD_ZZZ:
     default:
-        fprintf(stderr, "%s", lookup->message);
+        fprintf(stream, "%s", lookup->message);
         break;
     }
+}
+
+// print_maybe_stop - print a message and maybe stop the program
+
+static void
+print_maybe_stop(const Error *error, int status)
+{
+    // Print some messages like the version on stdout and stop with success
+    if (lookup_any_error(error->code)->field == FIELD_S_ON_STDOUT)
+    {
+        fprint_error(stdout, error);
+        exit(EXIT_SUCCESS);
+    }
+    fprint_error(stderr, error);
 
     // Maybe stop the program
     if (status)
@@ -140,22 +171,28 @@ print_maybe_stop(const Error *error, int status)
     }
 }
 
-// print_diagnostics - print any validation diagnostics
+// fprint_diagnostics, print_diagnostics - print any validation
+// diagnostics to a stream or to stderr
 
 void
-print_diagnostics(const Diagnostics *diagnostics)
+fprint_diagnostics(FILE *stream, const Diagnostics *diagnostics)
 {
     if (diagnostics)
     {
         size_t i;
         for (i = 0; i < diagnostics->length; i++)
         {
-            const Error *error = &diagnostics->array[i];
-            print_maybe_stop(error, 0);
+            fprint_error(stream, &diagnostics->array[i]);
         }
     }
 }
 
+void
+print_diagnostics(const Diagnostics *diagnostics)
+{
+    fprint_diagnostics(stderr, diagnostics);
+}
+
 // continue_or_exit - print and exit if any error or continue otherwise
 
 void
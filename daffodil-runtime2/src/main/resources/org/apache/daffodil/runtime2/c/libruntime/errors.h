@@ -74,6 +74,7 @@ typedef struct Error
 
 enum Limits
 {
+    LIMIT_BLOCK_SIZE = 65536, // limits how many bytes I/O buffers can hold
     LIMIT_DIAGNOSTICS = 100,  // limits how many diagnostics can accumulate
     LIMIT_NAME_LENGTH = 9999, // limits how long infoset names can become
 };
@@ -90,16 +91,23 @@ typedef struct Diagnostics
 
 extern const Error *eof_or_error(FILE *stream);
 
-// get_diagnostics - get pointer to validation diagnostics
-
-extern Diagnostics *get_diagnostics(void);
-
 // add_diagnostic - add a new error to validation diagnostics
 
 extern bool add_diagnostic(Diagnostics *diagnostics, const Error *error);
 
-// print_diagnostics - print any validation diagnostics
+// copy_error - copy an error into storage which outlives the error's
+// source, copying its string argument (if it has one) into text
+
+extern const Error *copy_error(Error *copy, char *text, size_t capacity, const Error *error);
+
+// fprint_error - print an error's message to a stream
+
+extern void fprint_error(FILE *stream, const Error *error);
+
+// fprint_diagnostics, print_diagnostics - print any validation
+// diagnostics to a stream or to stderr
 
+extern void fprint_diagnostics(FILE *stream, const Diagnostics *diagnostics);
 extern void print_diagnostics(const Diagnostics *diagnostics);
 
 // continue_or_exit - print and exit if any error or continue otherwise
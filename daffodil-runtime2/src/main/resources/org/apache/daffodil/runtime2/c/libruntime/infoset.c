@@ -17,184 +17,110 @@
 
 // clang-format off
 #include "infoset.h"
-#include <string.h>  // for memccpy
-#include "errors.h"  // for Error, LIMIT_NAME_LENGTH
+#include <stdbool.h>  // for bool
+#include <stdint.h>   // for int16_t, int32_t, int64_t, int8_t
+#include <stdlib.h>   // for calloc, free
+#include "errors.h"   // for Error
 // clang-format on
 
-// get_erd_name, get_erd_xmlns, get_erd_ns - get name and xmlns
-// attribute/value from ERD to use on XML element
+// new_context, free_context - allocate a runtime context with its own
+// root element or free a runtime context and its root element
 
-const char *
-get_erd_name(const ERD *erd)
+RuntimeContext *
+new_context(void)
 {
-    static char name[LIMIT_NAME_LENGTH];
-    char *      next = name;
-    char *      last = name + sizeof(name) - 1;
-
-    if (next && erd->namedQName.prefix)
-    {
-        next = memccpy(next, erd->namedQName.prefix, 0, last - next);
-        if (next)
-        {
-            --next;
-        }
-    }
-    if (next && erd->namedQName.prefix)
+    RuntimeContext *context = calloc(1, sizeof(RuntimeContext));
+    if (context)
     {
-        next = memccpy(next, ":", 0, last - next);
-        if (next)
+        context->root = rootElement();
+        if (!context->root)
         {
-            --next;
+            free(context);
+            context = NULL;
         }
     }
-    if (next)
-    {
-        next = memccpy(next, erd->namedQName.local, 0, last - next);
-        if (next)
-        {
-            --next;
-        }
-    }
-    if (!next)
-    {
-        *last = 0;
-    }
-
-    return name;
+    return context;
 }
 
-const char *
-get_erd_xmlns(const ERD *erd)
+void
+free_context(RuntimeContext *context)
 {
-    if (erd->namedQName.ns)
-    {
-        static char xmlns[LIMIT_NAME_LENGTH];
-        char *      next = xmlns;
-        char *      last = xmlns + sizeof(xmlns) - 1;
-
-        next = memccpy(next, "xmlns", 0, last - next);
-        if (next)
-        {
-            --next;
-        }
-
-        if (next && erd->namedQName.prefix)
-        {
-            next = memccpy(next, ":", 0, last - next);
-            if (next)
-            {
-                --next;
-            }
-        }
-        if (next && erd->namedQName.prefix)
-        {
-            next = memccpy(next, erd->namedQName.prefix, 0, last - next);
-            if (next)
-            {
-                --next;
-            }
-        }
-        if (!next)
-        {
-            *last = 0;
-        }
-
-        return xmlns;
-    }
-    else
+    if (context)
     {
-        return NULL;
+        free(context->root);
+        free(context);
     }
 }
 
-const char *
-get_erd_ns(const ERD *erd)
-{
-    return erd->namedQName.ns;
-}
+// walkInfoset - walk a context's infoset and call VisitEventHandler methods
 
-// walkInfosetNode - recursively walk an infoset node and call
-// VisitEventHandler methods
-
-static const Error *
-walkInfosetNode(const VisitEventHandler *handler, const InfosetBase *infoNode)
+const Error *
+walkInfoset(const VisitEventHandler *handler, RuntimeContext *context)
 {
-    const Error *error = NULL;
-
-    // Start visiting the node
+    const Error *error = handler->visitStartDocument(handler);
     if (!error)
     {
-        error = handler->visitStartComplex(handler, infoNode);
+        error = context->root->erd->walkSelf(context->root, handler, context);
     }
-
-    // Walk the node's children recursively
-    const size_t      count = infoNode->erd->numChildren;
-    const ERD **const childrenERDs = infoNode->erd->childrenERDs;
-    const size_t *    offsets = infoNode->erd->offsets;
-
-    size_t i;
-    for (i = 0; i < count && !error; i++)
-    {
-        const size_t offset = offsets[i];
-        const ERD *  childERD = childrenERDs[i];
-        // We use only one of these variables below depending on typeCode
-        const InfosetBase *childNode = (const InfosetBase *)((const char *)infoNode + offset);
-        const void *       number = (const void *)((const char *)infoNode + offset);
-
-        // Will need to handle more element types
-        const enum TypeCode typeCode = childERD->typeCode;
-        switch (typeCode)
-        {
-        case CHOICE:
-            // Point next ERD to choice of alternative elements' ERDs
-            error = infoNode->erd->initChoice(infoNode, rootElement());
-            break;
-        case COMPLEX:
-            error = walkInfosetNode(handler, childNode);
-            break;
-        case PRIMITIVE_BOOLEAN:
-        case PRIMITIVE_DOUBLE:
-        case PRIMITIVE_FLOAT:
-        case PRIMITIVE_INT16:
-        case PRIMITIVE_INT32:
-        case PRIMITIVE_INT64:
-        case PRIMITIVE_INT8:
-        case PRIMITIVE_UINT16:
-        case PRIMITIVE_UINT32:
-        case PRIMITIVE_UINT64:
-        case PRIMITIVE_UINT8:
-            error = handler->visitNumberElem(handler, childERD, number);
-            break;
-        }
-    }
-
-    // End visiting the node
     if (!error)
     {
-        error = handler->visitEndComplex(handler, infoNode);
+        error = handler->visitEndDocument(handler);
     }
 
     return error;
 }
 
-// walkInfoset - walk an infoset and call VisitEventHandler methods
+// numberSize - get the size in bytes of a number with the given type
+// (0 if the type isn't a primitive number)
 
-const Error *
-walkInfoset(const VisitEventHandler *handler, const InfosetBase *infoset)
+size_t
+numberSize(enum TypeCode typeCode)
 {
-    const Error *error = NULL;
-
-    if (!error)
+    switch (typeCode)
     {
-        error = handler->visitStartDocument(handler);
+    case PRIMITIVE_BOOLEAN:
+        return sizeof(bool);
+    case PRIMITIVE_DOUBLE:
+        return sizeof(double);
+    case PRIMITIVE_FLOAT:
+        return sizeof(float);
+    case PRIMITIVE_INT16:
+    case PRIMITIVE_UINT16:
+        return sizeof(int16_t);
+    case PRIMITIVE_INT32:
+    case PRIMITIVE_UINT32:
+        return sizeof(int32_t);
+    case PRIMITIVE_INT64:
+    case PRIMITIVE_UINT64:
+        return sizeof(int64_t);
+    case PRIMITIVE_INT8:
+    case PRIMITIVE_UINT8:
+        return sizeof(int8_t);
+    default:
+        return 0;
     }
-    if (!error)
+}
+
+// walkNumberRun - visit a run of count adjacent numbers of the same
+// type with the handler's visitNumberRun method, or one at a time with
+// its visitNumberElem method if it has no visitNumberRun method
+
+const Error *
+walkNumberRun(const VisitEventHandler *handler, const ERD *const *erds, const void *numbers, size_t count)
+{
+    if (handler->visitNumberRun)
     {
-        error = walkInfosetNode(handler, infoset);
+        return handler->visitNumberRun(handler, erds, numbers, count);
     }
-    if (!error)
+
+    const Error *error = NULL;
+    const size_t size = numberSize(erds[0]->typeCode);
+    const char * number = numbers;
+
+    size_t i;
+    for (i = 0; i < count && !error; i++)
     {
-        error = handler->visitEndDocument(handler);
+        error = handler->visitNumberElem(handler, erds[i], number + i * size);
     }
 
     return error;
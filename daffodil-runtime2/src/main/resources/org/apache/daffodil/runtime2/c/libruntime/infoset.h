@@ -19,9 +19,11 @@
 #define INFOSET_H
 
 // clang-format off
-#include <stddef.h>  // for size_t
-#include <stdio.h>   // for FILE
-#include "errors.h"  // for Error, Diagnostics
+#include <stdbool.h>  // for bool
+#include <stddef.h>   // for size_t
+#include <stdint.h>   // for uint32_t
+#include <stdio.h>    // for FILE
+#include "errors.h"   // for Error, Diagnostics, LIMIT_BLOCK_SIZE
 // clang-format on
 
 // Prototypes needed for compilation
@@ -29,14 +31,18 @@
 struct ERD;
 struct InfosetBase;
 struct PState;
+struct RuntimeContext;
 struct UState;
 struct VisitEventHandler;
 
 typedef void (*ERDInitSelf)(struct InfosetBase *infoNode);
 typedef void (*ERDParseSelf)(struct InfosetBase *infoNode, struct PState *pstate);
 typedef void (*ERDUnparseSelf)(const struct InfosetBase *infoNode, struct UState *ustate);
-typedef const Error *(*InitChoiceRD)(const struct InfosetBase *infoNode,
-                                     const struct InfosetBase *rootElement);
+typedef const Error *(*ERDWalkSelf)(const struct InfosetBase *infoNode,
+                                    const struct VisitEventHandler *handler, struct RuntimeContext *context);
+typedef const Error *(*InitChoiceRD)(const struct InfosetBase *infoNode, struct RuntimeContext *context);
+typedef const Error *(*PStateRefill)(struct PState *pstate, size_t needed);
+typedef const Error *(*UStateFlush)(struct UState *ustate);
 
 typedef const Error *(*VisitStartDocument)(const struct VisitEventHandler *handler);
 typedef const Error *(*VisitEndDocument)(const struct VisitEventHandler *handler);
@@ -46,14 +52,27 @@ typedef const Error *(*VisitEndComplex)(const struct VisitEventHandler *handler,
                                         const struct InfosetBase *      base);
 typedef const Error *(*VisitNumberElem)(const struct VisitEventHandler *handler, const struct ERD *erd,
                                         const void *number);
+typedef const Error *(*VisitNumberRun)(const struct VisitEventHandler *handler, const struct ERD *const *erds,
+                                       const void *numbers, size_t count);
+
+// NAME_HASH_BASIS, NAME_HASH_PRIME - parameters of the 32-bit FNV-1a
+// hash of a qualified name's bytes (the code generator hashes each
+// ERD's name the same way so readers can match names by hash first)
+
+#define NAME_HASH_BASIS 2166136261u
+#define NAME_HASH_PRIME 16777619u
 
 // NamedQName - name of an infoset element
 
 typedef struct NamedQName
 {
-    const char *prefix; // prefix (optional, may be NULL)
-    const char *local;  // local name
-    const char *ns;     // namespace URI (optional, may be NULL)
+    const char *   prefix;     // prefix (optional, may be NULL)
+    const char *   local;      // local name
+    const char *   ns;         // namespace URI (optional, may be NULL)
+    const char *   name;       // qualified name (prefix:local or local)
+    const size_t   nameLength; // length of qualified name
+    const uint32_t nameHash;   // FNV-1a hash of qualified name
+    const char *   xmlns;      // xmlns attribute for ns (NULL if ns is NULL)
 } NamedQName;
 
 // TypeCode - types of infoset elements
@@ -81,6 +100,7 @@ typedef struct ERD
 {
     const NamedQName    namedQName;
     const enum TypeCode typeCode;
+    const bool          isArray;
     const size_t        numChildren;
     const size_t *      offsets;
     const struct ERD ** childrenERDs;
@@ -88,6 +108,7 @@ typedef struct ERD
     const ERDInitSelf    initSelf;
     const ERDParseSelf   parseSelf;
     const ERDUnparseSelf unparseSelf;
+    const ERDWalkSelf    walkSelf;
     const InitChoiceRD   initChoice;
 } ERD;
 
@@ -98,27 +119,56 @@ typedef struct InfosetBase
     const ERD *erd;
 } InfosetBase;
 
-// PState - mutable state while parsing data
+// RuntimeContext - mutable state owned by one thread which parsers,
+// unparsers, and visitors use instead of function-level statics (each
+// thread must create its own context to parse or unparse concurrently)
+
+typedef struct RuntimeContext
+{
+    InfosetBase *root;        // root element of infoset
+    Diagnostics  diagnostics; // storage for validation diagnostics
+    Error        error;       // storage for an error with an argument
+    char         errorText[LIMIT_NAME_LENGTH]; // storage for an error's string argument
+} RuntimeContext;
+
+// PState - mutable state while parsing data (parsers read data from
+// the input buffer between next and limit and call refill only when
+// they need more bytes than the input buffer has left)
 
 typedef struct PState
 {
-    FILE *       stream;      // input to read data from
-    size_t       position;    // 0-based position in stream
-    Diagnostics *diagnostics; // any validation diagnostics
-    const Error *error;       // any error which stops program
+    FILE *          stream;      // input to read data from
+    size_t          position;    // 0-based position in stream
+    Diagnostics *   diagnostics; // any validation diagnostics
+    const Error *   error;       // any error which stops program
+    RuntimeContext *context;     // storage used instead of statics
+    const char *    next;        // next unread byte in input buffer
+    const char *    limit;       // one past last unread byte in input buffer
+    PStateRefill    refill;      // refills input buffer with more bytes
+    char            block[LIMIT_BLOCK_SIZE]; // input buffer's storage
 } PState;
 
-// UState - mutable state while unparsing infoset
+// UState - mutable state while unparsing infoset (unparsers write
+// data into the output buffer between next and limit and call flush
+// only when the output buffer has no room left; callers must call
+// flush once more after unparsing to write the rest of the data)
 
 typedef struct UState
 {
-    FILE *       stream;      // output to write data to
-    size_t       position;    // 0-based position in stream
-    Diagnostics *diagnostics; // any validation diagnostics
-    const Error *error;       // any error which stops program
+    FILE *          stream;      // output to write data to
+    size_t          position;    // 0-based position in stream
+    Diagnostics *   diagnostics; // any validation diagnostics
+    const Error *   error;       // any error which stops program
+    RuntimeContext *context;     // storage used instead of statics
+    char *          next;        // next unwritten byte in output buffer
+    char *          limit;       // one past last byte in output buffer
+    UStateFlush     flush;       // flushes output buffer's written bytes
+    char            block[LIMIT_BLOCK_SIZE]; // output buffer's storage
 } UState;
 
 // VisitEventHandler - methods to be called when walking an infoset
+// (visitNumberRun is optional and visits a run of adjacent numbers of
+// the same type at once, each with its own ERD)
 
 typedef struct VisitEventHandler
 {
@@ -127,23 +177,43 @@ typedef struct VisitEventHandler
     const VisitStartComplex  visitStartComplex;
     const VisitEndComplex    visitEndComplex;
     const VisitNumberElem    visitNumberElem;
+    const VisitNumberRun     visitNumberRun;
 } VisitEventHandler;
 
-// get_erd_name, get_erd_xmlns, get_erd_ns - get name and xmlns
-// attribute/value from ERD to use for XML element
+// rootElement - allocate and initialize a new root element for
+// parsing, walking, or unparsing an infoset (implementation actually
+// is generated in generated_code.c, not defined in infoset.c)
 
-extern const char *get_erd_name(const ERD *erd);
-extern const char *get_erd_xmlns(const ERD *erd);
-extern const char *get_erd_ns(const ERD *erd);
+extern InfosetBase *rootElement(void);
 
-// rootElement - return an infoset's root element for parsing,
-// walking, or unparsing (implementation actually is generated in
-// generated_code.c, not defined in infoset.c)
+// rootElementFixedLength - whether every root element parses the same
+// number of bytes, letting callers split input into records without
+// parsing it (definition actually is generated in generated_code.c)
 
-extern InfosetBase *rootElement(void);
+extern const bool rootElementFixedLength;
+
+// new_context, free_context - allocate a runtime context with its own
+// root element or free a runtime context and its root element
+
+extern RuntimeContext *new_context(void);
+extern void            free_context(RuntimeContext *context);
+
+// walkInfoset - walk a context's infoset and call VisitEventHandler
+// methods (calls generated walkSelf functions which visit each element
+// with its known ERD instead of interpreting offsets and typeCodes)
+
+extern const Error *walkInfoset(const VisitEventHandler *handler, RuntimeContext *context);
+
+// numberSize - get the size in bytes of a number with the given type
+// (0 if the type isn't a primitive number)
+
+extern size_t numberSize(enum TypeCode typeCode);
 
-// walkInfoset - walk an infoset and call VisitEventHandler methods
+// walkNumberRun - visit a run of count adjacent numbers of the same
+// type with the handler's visitNumberRun method, or one at a time with
+// its visitNumberElem method if it has no visitNumberRun method
 
-extern const Error *walkInfoset(const VisitEventHandler *handler, const InfosetBase *infoset);
+extern const Error *walkNumberRun(const VisitEventHandler *handler, const ERD *const *erds,
+                                  const void *numbers, size_t count);
 
 #endif // INFOSET_H
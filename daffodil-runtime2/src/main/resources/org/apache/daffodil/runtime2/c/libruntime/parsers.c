@@ -20,7 +20,8 @@
 #include <endian.h>   // for be32toh, le32toh, be16toh, be64toh, le16toh, le64toh
 #include <stdbool.h>  // for bool, false, true
 #include <stdio.h>    // for fread
-#include "errors.h"   // for eof_or_error, Error, ERR_PARSE_BOOL, Error::(anonymous), add_diagnostic, get_diagnostics, ERR_FIXED_VALUE, Diagnostics
+#include <string.h>   // for memcpy, memmove
+#include "errors.h"   // for eof_or_error, Error, ERR_PARSE_BOOL, Error::(anonymous), add_diagnostic, ERR_FIXED_VALUE, Diagnostics, ERR_STREAM_EOF, UNUSED
 // clang-format on
 
 // Macros not defined by <endian.h> which we need for uniformity
@@ -28,17 +29,19 @@
 #define be8toh(var) var
 #define le8toh(var) var
 
-// Helper macro to reduce duplication of C code reading stream,
-// updating position, and checking for errors
+// Helper macro to reduce duplication of C code reading input buffer,
+// updating position, and checking for errors (refills input buffer
+// only when it has fewer bytes left than we need)
 
-#define read_stream_update_position                                                                          \
-    size_t count = fread(&buffer.c_val, 1, sizeof(buffer), pstate->stream);                                  \
-    pstate->position += count;                                                                               \
-    if (count < sizeof(buffer))                                                                              \
+#define read_buffer_update_position                                                                          \
+    if ((size_t)(pstate->limit - pstate->next) < sizeof(buffer))                                             \
     {                                                                                                        \
-        pstate->error = eof_or_error(pstate->stream);                                                        \
+        pstate->error = pstate->refill(pstate, sizeof(buffer));                                              \
         if (pstate->error) return;                                                                           \
-    }
+    }                                                                                                        \
+    memcpy(buffer.c_val, pstate->next, sizeof(buffer));                                                      \
+    pstate->next += sizeof(buffer);                                                                          \
+    pstate->position += sizeof(buffer);
 
 // Macros to define parse_<endian>_<type> functions
 
@@ -51,7 +54,7 @@
             uint##bits##_t i_val;                                                                            \
         } buffer;                                                                                            \
                                                                                                              \
-        read_stream_update_position;                                                                         \
+        read_buffer_update_position;                                                                         \
         buffer.i_val = endian##bits##toh(buffer.i_val);                                                      \
         if (true_rep < 0)                                                                                    \
         {                                                                                                    \
@@ -67,9 +70,10 @@
         }                                                                                                    \
         else                                                                                                 \
         {                                                                                                    \
-            static Error error = {ERR_PARSE_BOOL, {0}};                                                      \
-            error.arg.d64 = (int64_t)buffer.i_val;                                                           \
-            pstate->error = &error;                                                                          \
+            Error *error = &pstate->context->error;                                                          \
+            error->code = ERR_PARSE_BOOL;                                                                    \
+            error->arg.d64 = (int64_t)buffer.i_val;                                                          \
+            pstate->error = error;                                                                           \
         }                                                                                                    \
     }
 
@@ -83,7 +87,7 @@
             uint##bits##_t i_val;                                                                            \
         } buffer;                                                                                            \
                                                                                                              \
-        read_stream_update_position;                                                                         \
+        read_buffer_update_position;                                                                         \
         buffer.i_val = endian##bits##toh(buffer.i_val);                                                      \
         *number = buffer.f_val;                                                                              \
     }
@@ -97,7 +101,7 @@
             type##bits##_t i_val;                                                                            \
         } buffer;                                                                                            \
                                                                                                              \
-        read_stream_update_position;                                                                         \
+        read_buffer_update_position;                                                                         \
         *number = endian##bits##toh(buffer.i_val);                                                           \
     }
 
@@ -137,19 +141,84 @@ define_parse_endian_integer(le, uint, 32)
 define_parse_endian_integer(le, uint, 64)
 define_parse_endian_integer(le, uint, 8)
 
+// Refill input buffer from stream, keeping any unread bytes
+
+const Error *
+refill_from_stream(PState *pstate, size_t needed)
+{
+    // Move any unread bytes to the front of the input buffer
+    size_t unread = (size_t)(pstate->limit - pstate->next);
+    if (unread)
+    {
+        memmove(pstate->block, pstate->next, unread);
+    }
+    pstate->next = pstate->block;
+    pstate->limit = pstate->block + unread;
+
+    // Fill the rest of the input buffer with one fread call
+    size_t count = fread(pstate->block + unread, 1, sizeof(pstate->block) - unread, pstate->stream);
+    pstate->limit += count;
+    if (unread + count < needed)
+    {
+        return eof_or_error(pstate->stream);
+    }
+    return NULL;
+}
+
+// Refill input buffer from memory, which has no more bytes to give
+// (input buffer already holds all of the input)
+
+const Error *
+refill_from_memory(PState *pstate, size_t needed)
+{
+    UNUSED(pstate);
+    UNUSED(needed);
+
+    static const Error error = {ERR_STREAM_EOF, {0}};
+    return &error;
+}
+
+// Check whether input has any bytes left to parse (sets pstate->error
+// only if reading input fails for a reason other than EOF)
+
+bool
+parse_has_more_data(PState *pstate)
+{
+    if (pstate->next != pstate->limit)
+    {
+        return true;
+    }
+
+    const Error *error = pstate->refill(pstate, 1);
+    if (error && error->code != ERR_STREAM_EOF)
+    {
+        pstate->error = error;
+    }
+    return !error;
+}
+
 // Parse fill bytes until end position is reached
 
 void
 parse_fill_bytes(size_t end_position, PState *pstate)
 {
-    union
-    {
-        char c_val[1];
-    } buffer;
-
     while (pstate->position < end_position)
     {
-        read_stream_update_position;
+        if (pstate->next == pstate->limit)
+        {
+            pstate->error = pstate->refill(pstate, 1);
+            if (pstate->error) return;
+        }
+
+        // Skip as many fill bytes as the input buffer holds
+        size_t available = (size_t)(pstate->limit - pstate->next);
+        size_t skip = end_position - pstate->position;
+        if (skip > available)
+        {
+            skip = available;
+        }
+        pstate->next += skip;
+        pstate->position += skip;
     }
 }
 
@@ -160,7 +229,7 @@ parse_validate_fixed(bool same, const char *element, PState *pstate)
 {
     if (!same)
     {
-        Diagnostics *diagnostics = get_diagnostics();
+        Diagnostics *diagnostics = &pstate->context->diagnostics;
         const Error  error = {ERR_FIXED_VALUE, {.s = element}};
 
         add_diagnostic(diagnostics, &error);
@@ -22,6 +22,7 @@
 #include <stdbool.h>  // for bool
 #include <stddef.h>   // for size_t
 #include <stdint.h>   // for int64_t, uint32_t, int16_t, int32_t, int8_t, uint16_t, uint64_t, uint8_t
+#include "errors.h"   // for Error
 #include "infoset.h"  // for PState
 // clang-format on
 
@@ -61,6 +62,18 @@ extern void parse_le_uint32(uint32_t *number, PState *pstate);
 extern void parse_le_uint64(uint64_t *number, PState *pstate);
 extern void parse_le_uint8(uint8_t *number, PState *pstate);
 
+// Refill input buffer from stream, keeping any unread bytes
+
+extern const Error *refill_from_stream(PState *pstate, size_t needed);
+
+// Refill input buffer from memory, which has no more bytes to give
+
+extern const Error *refill_from_memory(PState *pstate, size_t needed);
+
+// Check whether input has any bytes left to parse
+
+extern bool parse_has_more_data(PState *pstate);
+
 // Parse fill bytes until end position is reached
 
 extern void parse_fill_bytes(size_t end_position, PState *pstate);
@@ -20,7 +20,8 @@
 #include <endian.h>   // for htobe32, htole32, htobe16, htobe64, htole16, htole64
 #include <stdbool.h>  // for bool
 #include <stdio.h>    // for fwrite
-#include "errors.h"   // for eof_or_error, add_diagnostic, get_diagnostics, ERR_FIXED_VALUE, Diagnostics, Error
+#include <string.h>   // for memcpy, memset
+#include "errors.h"   // for eof_or_error, add_diagnostic, ERR_FIXED_VALUE, Diagnostics, Error
 // clang-format on
 
 // Macros not defined by <endian.h> which we need for uniformity
@@ -28,17 +29,19 @@
 #define htobe8(var) var
 #define htole8(var) var
 
-// Helper macro to reduce duplication of C code writing stream,
-// updating position, and checking for errors
+// Helper macro to reduce duplication of C code writing output buffer,
+// updating position, and checking for errors (flushes output buffer
+// only when it has less room left than we need)
 
-#define write_stream_update_position                                                                         \
-    size_t count = fwrite(buffer.c_val, 1, sizeof(buffer), ustate->stream);                                  \
-    ustate->position += count;                                                                               \
-    if (count < sizeof(buffer))                                                                              \
+#define write_buffer_update_position                                                                         \
+    if ((size_t)(ustate->limit - ustate->next) < sizeof(buffer))                                             \
     {                                                                                                        \
-        ustate->error = eof_or_error(ustate->stream);                                                        \
+        ustate->error = ustate->flush(ustate);                                                               \
         if (ustate->error) return;                                                                           \
-    }
+    }                                                                                                        \
+    memcpy(ustate->next, buffer.c_val, sizeof(buffer));                                                      \
+    ustate->next += sizeof(buffer);                                                                          \
+    ustate->position += sizeof(buffer);
 
 // Macros to define unparse_<endian>_<type> functions
 
@@ -52,7 +55,7 @@
         } buffer;                                                                                            \
                                                                                                              \
         buffer.i_val = hto##endian##bits(number ? true_rep : false_rep);                                     \
-        write_stream_update_position;                                                                        \
+        write_buffer_update_position;                                                                        \
     }
 
 #define define_unparse_endian_real(endian, type, bits)                                                       \
@@ -67,7 +70,7 @@
                                                                                                              \
         buffer.f_val = number;                                                                               \
         buffer.i_val = hto##endian##bits(buffer.i_val);                                                      \
-        write_stream_update_position;                                                                        \
+        write_buffer_update_position;                                                                        \
     }
 
 #define define_unparse_endian_integer(endian, type, bits)                                                    \
@@ -80,7 +83,7 @@
         } buffer;                                                                                            \
                                                                                                              \
         buffer.i_val = hto##endian##bits(number);                                                            \
-        write_stream_update_position;                                                                        \
+        write_buffer_update_position;                                                                        \
     }
 
 // Unparse binary booleans, real numbers, and integers
@@ -119,21 +122,46 @@ define_unparse_endian_integer(le, uint, 32)
 define_unparse_endian_integer(le, uint, 64)
 define_unparse_endian_integer(le, uint, 8)
 
-// Unparse fill bytes until end position is reached
+// Flush output buffer to stream, emptying it for more data
 
-void
-unparse_fill_bytes(size_t end_position, const char fill_byte, UState *ustate)
+const Error *
+flush_to_stream(UState *ustate)
 {
-    union
+    // Write any bytes in the output buffer with one fwrite call
+    size_t written = ustate->next ? (size_t)(ustate->next - ustate->block) : 0;
+    size_t count = fwrite(ustate->block, 1, written, ustate->stream);
+    ustate->next = ustate->block;
+    ustate->limit = ustate->block + sizeof(ustate->block);
+    if (count < written)
     {
-        char c_val[1];
-    } buffer;
+        return eof_or_error(ustate->stream);
+    }
+    return NULL;
+}
 
-    buffer.c_val[0] = fill_byte;
+// Unparse fill bytes until end position is reached
 
+void
+unparse_fill_bytes(size_t end_position, const char fill_byte, UState *ustate)
+{
     while (ustate->position < end_position)
     {
-        write_stream_update_position;
+        if (ustate->next == ustate->limit)
+        {
+            ustate->error = ustate->flush(ustate);
+            if (ustate->error) return;
+        }
+
+        // Fill as many bytes as the output buffer has room for
+        size_t room = (size_t)(ustate->limit - ustate->next);
+        size_t fill = end_position - ustate->position;
+        if (fill > room)
+        {
+            fill = room;
+        }
+        memset(ustate->next, fill_byte, fill);
+        ustate->next += fill;
+        ustate->position += fill;
     }
 }
 
@@ -144,7 +172,7 @@ unparse_validate_fixed(bool same, const char *element, UState *ustate)
 {
     if (!same)
     {
-        Diagnostics *diagnostics = get_diagnostics();
+        Diagnostics *diagnostics = &ustate->context->diagnostics;
         const Error  error = {ERR_FIXED_VALUE, {.s = element}};
 
         add_diagnostic(diagnostics, &error);
@@ -22,6 +22,7 @@
 #include <stdbool.h>  // for bool
 #include <stddef.h>   // for size_t
 #include <stdint.h>   // for uint32_t, int16_t, int32_t, int64_t, int8_t, uint16_t, uint64_t, uint8_t
+#include "errors.h"   // for Error
 #include "infoset.h"  // for UState
 // clang-format on
 
@@ -61,6 +62,10 @@ extern void unparse_le_uint32(uint32_t number, UState *ustate);
 extern void unparse_le_uint64(uint64_t number, UState *ustate);
 extern void unparse_le_uint8(uint8_t number, UState *ustate);
 
+// Flush output buffer to stream, emptying it for more data
+
+extern const Error *flush_to_stream(UState *ustate);
+
 // Unparse fill bytes until end position is reached
 
 extern void unparse_fill_bytes(size_t end_position, const char fill_byte, UState *ustate);
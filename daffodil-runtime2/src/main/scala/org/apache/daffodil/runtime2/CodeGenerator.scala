@@ -18,18 +18,24 @@
 package org.apache.daffodil.runtime2
 
 import java.io.File
+import java.io.IOException
+import java.nio.ByteBuffer
+import java.nio.charset.StandardCharsets
 import java.nio.file.FileSystems
 import java.nio.file.Files
 import java.nio.file.Paths
+import java.security.MessageDigest
 import java.util.Collections
 import org.apache.daffodil.api.DFDL
 import org.apache.daffodil.api.Diagnostic
+import org.apache.daffodil.api.Runtime2BuildProfile
 import org.apache.daffodil.dsom.Root
 import org.apache.daffodil.dsom.SchemaDefinitionError
 import org.apache.daffodil.runtime2.generators.CodeGeneratorState
 import org.apache.daffodil.util.Misc
 import org.apache.daffodil.xml.RefQName
 
+import scala.util.Properties.isMac
 import scala.util.Properties.isWin
 
 /**
@@ -102,46 +108,337 @@ class CodeGenerator(root: Root) extends DFDL.CodeGenerator {
   }
 
   /**
-   * Compiles any C source files inside the given code directory.  Returns the path
-   * of the newly built executable in order to run it in a TDML test.
+   * Compiles any C source files inside the given code directory with the build
+   * profile given by the runtime2BuildProfile tunable.  Returns the path of the
+   * newly built executable in order to run it in a TDML test.
    */
-  override def compileCode(codeDir: os.Path): os.Path = {
+  override def compileCode(codeDir: os.Path): os.Path =
+    compileCode(codeDir, root.tunable.runtime2BuildProfile)
+
+  /**
+   * Compiles any C source files inside the given code directory with the given
+   * build profile.  Returns the path of the newly built executable.
+   */
+  override def compileCode(codeDir: os.Path, profile: Runtime2BuildProfile): os.Path = {
     // Get the path of the executable we will build
     val exe = if (isWin) codeDir/"daffodil.exe" else codeDir/"daffodil"
 
+    // Build the executable
+    compile(codeDir, profileFlags(profile), Seq.empty, Seq("-lpthread"), exe)
+
+    // Report any failure to build the executable as an error
+    if (!os.exists(exe)) error("No executable was built: %s", exe.toString)
+
+    // Return our executable in case caller wants to run it next
+    exe
+  }
+
+  /**
+   * Compiles any C source files inside the given code directory with the given
+   * build profile and profile-guided optimization.  Builds an instrumented
+   * executable first, runs it over each training input (parsing the input to
+   * an XML infoset and unparsing that infoset again), and then rebuilds the
+   * executable using the collected profile, which lets the compiler lay out
+   * hot paths such as choice dispatch switches for the data the executable
+   * will really see.  Builds without profile-guided optimization if given no
+   * training inputs.  Returns the path of the newly built executable.
+   */
+  override def compileTrainedCode(codeDir: os.Path, profile: Runtime2BuildProfile,
+                                  trainingInputs: Seq[os.Path]): os.Path = {
+    if (trainingInputs.isEmpty) {
+      compileCode(codeDir, profile)
+    } else {
+      // Get the path of the executable we will build and the profile directory
+      // (the absolute executable path lets gcc match profiles between builds)
+      val exe = if (isWin) codeDir/"daffodil.exe" else codeDir/"daffodil"
+      val profileDir = codeDir/"pgo"
+      os.remove.all(profileDir)
+      os.makeDir.all(profileDir)
+
+      // Stage 1: build an instrumented executable
+      // (profiles are named after object files, so don't use cached ones)
+      compile(codeDir, profileFlags(profile) :+ s"-fprofile-generate=$profileDir", Seq.empty, Seq("-lpthread"), exe,
+        cached = false)
+
+      // Stage 2: run the instrumented executable over the training inputs
+      if (os.exists(exe)) {
+        val infoset = profileDir/"training.xml"
+        val data = profileDir/"training.dat"
+        trainingInputs.foreach { input =>
+          try {
+            os.proc(exe, "-o", infoset, "parse", input).call(cwd = codeDir, stderr = os.Pipe)
+            os.proc(exe, "-o", data, "unparse", infoset).call(cwd = codeDir, stderr = os.Pipe)
+          } catch {
+            // Report any training run's failure as a warning
+            case e: os.SubprocessException =>
+              warning("Training run failed on %s: %s", input.toString, Misc.getSomeMessage(e).get)
+          }
+        }
+        os.remove.all(infoset)
+        os.remove.all(data)
+
+        // Stage 3: rebuild the executable with the collected profile
+        val useFlags = profileUseFlags(profileDir)
+        os.remove(exe)
+        compile(codeDir, profileFlags(profile) ++ useFlags, Seq.empty, Seq("-lpthread"), exe, cached = false)
+      }
+
+      // Report any failure to build the executable as an error
+      if (!os.exists(exe)) error("No executable was built: %s", exe.toString)
+
+      // Return our executable in case caller wants to run it next
+      exe
+    }
+  }
+
+  /**
+   * Returns the compiler flags for using the profile collected in the given
+   * directory.  Clang needs its raw profiles merged by llvm-profdata first;
+   * if that fails, warns and returns no flags (building without a profile).
+   */
+  private def profileUseFlags(profileDir: os.Path): Seq[String] = {
+    if (!isClang) {
+      // Don't fail on counts which racing threads left inconsistent, and
+      // don't warn about each file missing its profile when every training
+      // run failed (we already warned about those runs)
+      Seq(s"-fprofile-use=$profileDir", "-fprofile-correction", "-Wno-missing-profile")
+    } else {
+      val profdata = profileDir/"default.profdata"
+      val rawProfiles = os.list(profileDir).filter(_.ext == "profraw")
+      try {
+        os.proc("llvm-profdata", "merge", "-o", profdata, rawProfiles).call(cwd = profileDir, stderr = os.Pipe)
+        Seq(s"-fprofile-use=$profdata")
+      } catch {
+        case e @ (_: os.SubprocessException | _: java.io.IOException) =>
+          warning("Unable to merge profiles with llvm-profdata, building without them: %s",
+            Misc.getSomeMessage(e).get)
+          Seq.empty
+      }
+    }
+  }
+
+  /**
+   * Compiles any C source files inside the given code directory into a shared
+   * library which a JVM can load to parse and unparse in-process with
+   * Runtime2Library instead of running the executable.  Needs the JDK's JNI
+   * headers to compile the native methods.  Uses the build profile given by
+   * the runtime2BuildProfile tunable.  Returns the path of the newly built
+   * shared library.
+   */
+  override def compileLibrary(codeDir: os.Path): os.Path =
+    compileLibrary(codeDir, root.tunable.runtime2BuildProfile)
+
+  /**
+   * Compiles any C source files inside the given code directory into a shared
+   * library with the given build profile.  Returns the path of the newly built
+   * shared library.
+   */
+  override def compileLibrary(codeDir: os.Path, profile: Runtime2BuildProfile): os.Path = {
+    // Get the path of the shared library we will build
+    val lib = if (isMac) codeDir/"libdaffodil.dylib" else codeDir/"libdaffodil.so"
+
+    if (isWin) {
+      error("Building a shared library is not supported on Windows: %s", lib.toString)
+    } else {
+      // Find the JNI headers (java.home is the JDK's jre subdirectory in Java 8)
+      val javaHome = os.Path(System.getProperty("java.home"))
+      val jniDir = Seq(javaHome/"include", javaHome/os.up/"include").find(dir => os.exists(dir/"jni.h"))
+      if (jniDir.isEmpty) {
+        error("No JNI headers found for building a shared library: %s", javaHome.toString)
+      } else {
+        val platform = if (isMac) "darwin" else "linux"
+        val flags = Seq("-fPIC", "-DDAFFODIL_JNI", s"-I${jniDir.get}", s"-I${jniDir.get/platform}")
+        // Bind calls within the library to its own functions, not another
+        // schema's library's functions with the same names
+        val bind = if (isMac) Seq.empty else Seq("-Wl,-Bsymbolic")
+        compile(codeDir, profileFlags(profile) ++ flags, "-shared" +: bind, Seq("-lpthread", "-ldl"), lib)
+      }
+
+      // Report any failure to build the shared library as an error
+      if (!os.exists(lib)) error("No shared library was built: %s", lib.toString)
+    }
+
+    // Return our shared library in case caller wants to load it next
+    lib
+  }
+
+  /**
+   * Returns the compiler flags for a build profile:
+   *
+   *   - debug: debug information added to the compiler's default (no)
+   *     optimization, which is how the generated code was always built
+   *     before, just without debug information (compiles fastest)
+   *   - release: -O2 and link-time optimization
+   *   - native: -O3, link-time optimization, and instructions only this
+   *     machine's CPU may have
+   *
+   * Builds which fail with link-time optimization build again without it.
+   */
+  def profileFlags(profile: Runtime2BuildProfile): Seq[String] = profile match {
+    case Runtime2BuildProfile.Debug => Seq("-g")
+    case Runtime2BuildProfile.Release => Seq("-O2", LtoFlag)
+    case Runtime2BuildProfile.Native => Seq("-O3", LtoFlag, "-march=native")
+  }
+
+  // Link-time optimization using as many jobs as the machine has cores
+  // (plain -flto makes gcc print a note, which we would report as a warning)
+  private val LtoFlag = "-flto=auto"
+
+  /**
+   * Compiles any C source files inside the given code directory with the given
+   * compiler flags, then links them with the given link-only flags (such as
+   * -shared, which compilers warn about when only compiling) and libraries
+   * into the given output file, using and filling our compile cache unless
+   * told not to.
+   */
+  private def compile(codeDir: os.Path, flags: Seq[String], linkFlags: Seq[String], libs: Seq[String],
+                      output: os.Path, cached: Boolean = true): Unit = {
     try {
       // Assemble the compiler's command line arguments
       val compiler = pickCompiler
       val absFiles = os.walk(codeDir).filter(_.ext == "c")
       val relFiles = Seq("libcli/*.c", "libruntime/*.c")
-      val libs = Seq("-lmxml")
 
       // Run the compiler in the code directory (if we found "zig cc"
       // as a compiler, it will cache previously built files in zig's
       // global cache directory, not a local zig_cache directory)
       if (compiler.nonEmpty) {
-        val result = os
-          .proc(compiler, "-Ilibcli", "-Ilibruntime", if (isWin) relFiles else absFiles, libs, "-o", exe)
-          .call(cwd = codeDir, stderr = os.Pipe)
-
-        // Report any compiler output as a warning
-        if (result.out.text.nonEmpty || result.err.text.nonEmpty) {
-          warning("Unexpected compiler output on stdout: %s on stderr: %s", result.out.text, result.err.text)
+        // Fall back to compiling everything if our cache isn't usable.  Don't
+        // use the cache on Windows, where we pass the compiler relative globs
+        // instead of absolute source paths, since the cache must name each
+        // source and its object file separately by absolute path.
+        val usedCache = cached && !isWin && {
+          try {
+            compileCached(codeDir, compiler, flags, linkFlags, libs, output)
+            true
+          } catch {
+            case e: IOException =>
+              warning("Unable to use compile cache %s: %s", cacheDir.toString, Misc.getSomeMessage(e).get)
+              false
+          }
+        }
+        if (!usedCache) {
+          val result = runCompiler(codeDir, compiler, flags ++ linkFlags, if (isWin) relFiles else absFiles, libs,
+            "-o", output)
+          reportCompilerOutput(result)
         }
       }
     } catch {
+      // Link-time optimization needs a linker which can load the compiler's
+      // LTO plugin (and clang before 13 rejects -flto=auto), so warn and
+      // build again without it rather than fail
+      case e: os.SubprocessException if flags.contains(LtoFlag) =>
+        warning("Unable to compile generated code with %s, compiling without it: %s", LtoFlag,
+          Misc.getSomeMessage(e).get)
+        compile(codeDir, flags.filterNot(_ == LtoFlag), linkFlags, libs, output, cached)
       // Report any subprocess termination error as an error
       case e: os.SubprocessException =>
         error("Error compiling generated code: %s wd: %s", Misc.getSomeMessage(e).get, codeDir.toString)
     }
+  }
 
-    // Report any failure to build the executable as an error
-    if (!os.exists(exe)) error("No executable was built: %s", exe.toString)
+  /**
+   * Compiles with a content-addressed cache in the runtime2 cache directory.
+   * Copies a previously built output if the compiler, flags, link flags,
+   * libraries, and every source and header file are the same as before.
+   * Otherwise compiles each C source file which doesn't include the
+   * generated code into an
+   * object file named by a hash of the compiler, flags, the file, and the
+   * headers, reusing any such object file already built for another schema,
+   * so that only the generated code gets compiled for each new schema.
+   * Caches only objects and outputs whose compiles printed nothing, so that
+   * compiles with warnings run (and warn) again.
+   */
+  private def compileCached(codeDir: os.Path, compiler: Seq[String], flags: Seq[String], linkFlags: Seq[String],
+                            libs: Seq[String], output: os.Path): Unit = {
+    val sources = os.walk(codeDir).filter(_.ext == "c").sortBy(_.toString)
+    val headers = os.walk(codeDir).filter(_.ext == "h").sortBy(_.toString)
+    val contents = (sources ++ headers).map(file => file -> os.read.bytes(file)).toMap
+    def isGenerated(file: os.Path): Boolean = file.baseName == "generated_code" ||
+      new String(contents(file), StandardCharsets.UTF_8).contains("\"generated_code.h\"")
+    val (generatedSources, sharedSources) = sources.partition(isGenerated)
+    val sharedHeaders = headers.filterNot(isGenerated)
+    val setup = compiler ++ Seq(compilerVersion) ++ flags
 
-    // Return our executable in case caller wants to run it next
-    exe
+    def key(strings: Seq[String], files: Seq[os.Path]): String = {
+      val digest = MessageDigest.getInstance("SHA-256")
+      def add(bytes: Array[Byte]): Unit = {
+        digest.update(ByteBuffer.allocate(8).putLong(bytes.length.toLong).array)
+        digest.update(bytes)
+      }
+      strings.foreach(string => add(string.getBytes(StandardCharsets.UTF_8)))
+      files.foreach { file =>
+        add(file.relativeTo(codeDir).toString.getBytes(StandardCharsets.UTF_8))
+        add(contents(file))
+      }
+      digest.digest.map("%02x".format(_)).mkString
+    }
+
+    // Move a newly built file into the cache atomically so that concurrent
+    // compiles never see a partly written file
+    def store(built: os.Path, cachedFile: os.Path): Unit = {
+      os.makeDir.all(cachedFile/os.up)
+      val temp = os.temp(dir = cachedFile/os.up, prefix = "tmp-")
+      os.copy(built, temp, replaceExisting = true, copyAttributes = true)
+      os.move(temp, cachedFile, replaceExisting = true, atomicMove = true)
+    }
+
+    val cachedOutput = cacheDir/"outputs"/key(setup ++ linkFlags ++ libs, sources ++ headers)/output.last
+    if (os.exists(cachedOutput)) {
+      os.copy(cachedOutput, output, replaceExisting = true, copyAttributes = true)
+    } else {
+      var quiet = true
+      var temps = Seq.empty[os.Path]
+      try {
+        val objects = sharedSources.map { source =>
+          val cachedObject = cacheDir/"objects"/s"${key(setup, sharedHeaders :+ source)}.o"
+          if (os.exists(cachedObject)) {
+            cachedObject
+          } else {
+            val obj = os.temp(prefix = "daffodil-runtime2-", suffix = ".o")
+            temps :+= obj
+            val result = runCompiler(codeDir, compiler, flags, "-c", source, "-o", obj)
+            reportCompilerOutput(result)
+            quiet = quiet && isSilent(result)
+            if (isSilent(result)) store(obj, cachedObject)
+            obj
+          }
+        }
+        val result = runCompiler(codeDir, compiler, flags ++ linkFlags, generatedSources, objects, libs, "-o", output)
+        reportCompilerOutput(result)
+        if (quiet && isSilent(result) && os.exists(output)) store(output, cachedOutput)
+      } finally {
+        temps.foreach(os.remove.all)
+      }
+    }
   }
 
+  /**
+   * Runs the compiler in the code directory with the given flags and
+   * arguments, throwing os.SubprocessException if it fails.
+   */
+  private def runCompiler(codeDir: os.Path, compiler: Seq[String], flags: Seq[String],
+                          args: os.Shellable*): os.CommandResult =
+    os.proc(compiler, flags, "-Ilibcli", "-Ilibruntime", args).call(cwd = codeDir, stderr = os.Pipe)
+
+  private def isSilent(result: os.CommandResult): Boolean =
+    result.out.text.isEmpty && result.err.text.isEmpty
+
+  /**
+   * Reports any compiler output as a warning.
+   */
+  private def reportCompilerOutput(result: os.CommandResult): Unit =
+    if (!isSilent(result)) {
+      warning("Unexpected compiler output on stdout: %s on stderr: %s", result.out.text, result.err.text)
+    }
+
+  /**
+   * Returns the directory holding our compile cache (see compileCached), which
+   * lives under the tempFilePath tunable's directory.  Delete it any time to
+   * reclaim its space.
+   */
+  lazy val cacheDir: os.Path = os.Path(root.tunable.tempFilePath.getAbsolutePath)/"daffodil-runtime2-cache"
+
   /**
    * Searches for any available C compiler on the system.  Tries to find the
    * compiler given by `CC` if `CC` exists in the environment, then tries to
@@ -175,6 +472,21 @@ class CodeGenerator(root: Root) extends DFDL.CodeGenerator {
       Seq.empty[String]
   }
 
+  /**
+   * Returns true if the picked compiler is clang (including "zig cc" and
+   * Apple's cc), whose profile-guided optimization differs from gcc's.
+   */
+  lazy val isClang: Boolean = compilerVersion.contains("clang")
+
+  /**
+   * Returns the picked compiler's version text (empty if it has none), which
+   * keys our compile cache along with the compiler's name.
+   */
+  lazy val compilerVersion: String = if (pickCompiler.isEmpty) "" else {
+    try os.proc(pickCompiler, "--version").call(stderr = os.Pipe).out.text
+    catch { case _: os.SubprocessException => "" }
+  }
+
   /**
    * Adds a warning message to the diagnostics
    */
@@ -17,9 +17,18 @@
 
 package org.apache.daffodil.runtime2
 
+import java.io.BufferedInputStream
+import java.io.BufferedOutputStream
+import java.io.ByteArrayInputStream
+import java.io.DataInputStream
+import java.io.DataOutputStream
 import java.io.File
+import java.io.IOException
 import java.io.InputStream
 import java.io.OutputStream
+import java.nio.charset.StandardCharsets
+import java.util.concurrent.ConcurrentLinkedQueue
+import org.apache.commons.io.IOUtils
 import org.apache.daffodil.api.DFDL
 import org.apache.daffodil.api.DaffodilTunables
 import org.apache.daffodil.api.DataLocation
@@ -40,9 +49,12 @@ import org.apache.daffodil.util.Maybe.Nope
 /**
  * Effectively a scala proxy object that does its work via the underlying C-code.
  * Will need to consider how to use features of underlying C-code to get infoset,
- * walk infoset, generate XML for use by TDML tests.
+ * walk infoset, generate XML for use by TDML tests.  Runs the executable built by
+ * CodeGenerator.compileCode, or calls the shared library built by
+ * CodeGenerator.compileLibrary in-process if given one.
  */
-class Runtime2DataProcessor(executableFile: os.Path) extends DFDL.DataProcessorBase {
+class Runtime2DataProcessor(executableFile: os.Path, libraryFile: Option[os.Path] = None)
+  extends DFDL.DataProcessorBase {
 
   override def withValidationMode(mode: ValidationMode.Type): DFDL.DataProcessor = ???
 
@@ -78,39 +90,96 @@ class Runtime2DataProcessor(executableFile: os.Path) extends DFDL.DataProcessorB
 
   override def setTunables(tunables: Map[String, String]): Unit = ???
 
+  /**
+   * Keeps idle workers (long-lived "daffodil serve" processes running our
+   * executable) so that parse and unparse pay the cost of starting the
+   * executable only once per worker instead of once per call.  Callers
+   * running at the same time each take their own worker, starting a new
+   * one if none are idle.
+   */
+  private val idleWorkers = new ConcurrentLinkedQueue[Runtime2Worker]()
+
+  /**
+   * Runs body with an idle worker (or a new one if none are idle), putting
+   * the worker back for reuse only if body finished without an exception.
+   */
+  private def withWorker[T](body: Runtime2Worker => T): T = {
+    var worker = idleWorkers.poll()
+    while (worker != null && !worker.isAlive) {
+      worker.close()
+      worker = idleWorkers.poll()
+    }
+    if (worker == null) worker = new Runtime2Worker(executableFile)
+
+    var reusable = false
+    try {
+      val result = body(worker)
+      reusable = true
+      result
+    } finally {
+      if (reusable) idleWorkers.offer(worker) else worker.close()
+    }
+  }
+
+  /**
+   * Counts the idle workers waiting to be reused (for tests).
+   */
+  private[runtime2] def idleWorkerCount: Int = idleWorkers.size
+
+  /**
+   * Loads our shared library if we have one.
+   */
+  private val library = libraryFile.map(new Runtime2Library(_))
+
+  /**
+   * Carries out one request in-process with our shared library if we have
+   * one, else with a worker.
+   */
+  private def request(command: Byte, data: Array[Byte]): Runtime2Worker.Reply =
+    library match {
+      case Some(lib) => lib.request(command, data)
+      case None => withWorker(_.request(command, data))
+    }
+
+  /**
+   * Stops all idle workers (workers still busy stop when they finish) and
+   * closes our shared library if we loaded it.
+   */
+  def close(): Unit = {
+    var worker = idleWorkers.poll()
+    while (worker != null) {
+      worker.close()
+      worker = idleWorkers.poll()
+    }
+    library.foreach(_.close())
+  }
+
   /**
    * Returns an object which contains the result, and/or diagnostic information.
    */
   def parse(input: InputStream): ParseResult = {
-    val tempDir = os.temp.dir(dir = null, prefix = "daffodil-runtime2-")
-    val infile = tempDir/"infile"
-    val outfile = tempDir/"outfile"
+    val data = IOUtils.toByteArray(input)
     try {
-      os.write(infile, input)
-      val result = os.proc(executableFile, "-o", outfile, "parse", infile).call(cwd = tempDir, stderr = os.Pipe)
-      if (result.out.text.isEmpty && result.err.text.isEmpty) {
-        val parseResult = new ParseResult(outfile, Success, infile)
+      val reply = request(Runtime2Worker.Parse, data)
+      if (reply.succeeded && reply.messages.isEmpty) {
+        val parseResult = new ParseResult(reply.output, Success, data.length)
         parseResult
       } else {
-        val msg = s"Unexpected daffodil output on stdout: ${result.out.text} on stderr: ${result.err.text}"
+        val msg = if (reply.succeeded)
+          s"Unexpected daffodil output on stderr: ${reply.messages}"
+        else
+          s"daffodil parse failed with stderr: ${reply.messages}"
         val parseError = new ParseError(Nope, Nope, Nope, Maybe(msg))
-        val parseResult = new ParseResult(outfile, Failure(parseError), infile)
+        val parseResult = new ParseResult(reply.output, Failure(parseError), data.length)
         parseResult.addDiagnostic(parseError)
         parseResult
       }
     } catch {
-      case e: os.SubprocessException =>
-        val parseError = if (e.result.out.text.isEmpty && e.result.err.text.isEmpty) {
-          new ParseError(Nope, Nope, Maybe(e), Nope)
-        } else {
-          val msg = s"${e.getMessage} with stdout: ${e.result.out.text} and stderr: ${e.result.err.text}"
-          new ParseError(Nope, Nope, Nope, Maybe(msg))
-        }
-        val parseResult = new ParseResult(outfile, Failure(parseError), infile)
+      case e: IOException =>
+        val parseError = new ParseError(Nope, Nope, Maybe(e), Nope)
+        val parseResult = new ParseResult(Array.empty[Byte], Failure(parseError), data.length)
         parseResult.addDiagnostic(parseError)
         parseResult
-    } finally {
-      os.remove.all(tempDir)
     }
   }
 
@@ -118,42 +187,123 @@ class Runtime2DataProcessor(executableFile: os.Path) extends DFDL.DataProcessorB
    * Unparses (that is, serializes) data to the output, returns an object which contains any diagnostics.
    */
   def unparse(input: InputStream, output: OutputStream): UnparseResult = {
-    val tempDir = os.temp.dir(dir = null, prefix = "daffodil-runtime2-")
-    val infile = tempDir/"infile"
-    val outfile = tempDir/"outfile"
+    val infoset = IOUtils.toByteArray(input)
     try {
-      os.write(infile, input)
-      val result = os.proc(executableFile, "-o", outfile, "unparse", infile).call(cwd = tempDir, stderr = os.Pipe)
-      val finalBitPos0b = os.size(outfile) * 8 // File sizes are bytes, so must multiply to get final position in bits
-      os.read.stream(outfile).writeBytesTo(output)
-      if (result.out.text.isEmpty && result.err.text.isEmpty) {
+      val reply = request(Runtime2Worker.Unparse, infoset)
+      if (reply.succeeded && reply.messages.isEmpty) {
+        output.write(reply.output)
+        val finalBitPos0b = reply.output.length * 8L // Lengths are bytes, so must multiply to get final position in bits
         val unparseResult = new UnparseResult(finalBitPos0b, Success)
         unparseResult
       } else {
-        val msg = s"Unexpected daffodil output on stdout: ${result.out.text} on stderr: ${result.err.text}"
+        val msg = if (reply.succeeded)
+          s"Unexpected daffodil output on stderr: ${reply.messages}"
+        else
+          s"daffodil unparse failed with stderr: ${reply.messages}"
         val unparseError = new UnparseError(Nope, Nope, Nope, Maybe(msg))
+        // Write data only if unparse succeeded, like the unparse command
+        // would have written it before reporting its diagnostics
+        val finalBitPos0b = if (reply.succeeded) {
+          output.write(reply.output)
+          reply.output.length * 8L
+        } else 0L
         val unparseResult = new UnparseResult(finalBitPos0b, Failure(unparseError))
         unparseResult.addDiagnostic(unparseError)
         unparseResult
       }
     } catch {
-      case e: os.SubprocessException =>
-        val unparseError = if (e.result.out.text.isEmpty && e.result.err.text.isEmpty) {
-          new UnparseError(Nope, Nope, Maybe(e), Nope)
-        } else {
-          val msg = s"${e.getMessage} with stdout: ${e.result.out.text} and stderr: ${e.result.err.text}"
-          new UnparseError(Nope, Nope, Nope, Maybe(msg))
-        }
+      case e: IOException =>
+        val unparseError = new UnparseError(Nope, Nope, Maybe(e), Nope)
         val finalBitPos0b = 0L
         val unparseResult = new UnparseResult(finalBitPos0b, Failure(unparseError))
         unparseResult.addDiagnostic(unparseError)
         unparseResult
-    } finally {
-      os.remove.all(tempDir)
     }
   }
 }
 
+/**
+ * Runs our executable as a long-lived "daffodil serve" process and sends
+ * it framed requests on its stdin, reading its framed replies from its
+ * stdout (see serve_requests.h for the protocol).  Not thread-safe; give
+ * each thread its own worker.
+ */
+final class Runtime2Worker(executableFile: os.Path) {
+  private val process = os.proc(executableFile, "serve").spawn(stderr = os.Pipe)
+  private val toProcess = new DataOutputStream(new BufferedOutputStream(process.stdin))
+  private val fromProcess = new DataInputStream(new BufferedInputStream(process.stdout))
+
+  // Replies carry each request's diagnostics, so anything the process
+  // writes on stderr means it is dying.  Drain stderr on its own thread so
+  // a full pipe can't block the process, and keep what it said for the
+  // IOException we throw when its replies stop.
+  private val errors = new StringBuffer
+  private val errorDrainer = new Thread(new Runnable {
+    override def run(): Unit = {
+      val source = scala.io.Source.fromInputStream(process.stderr, "UTF-8")
+      try source.getLines().foreach(line => errors.append(line).append('\n'))
+      catch { case _: IOException => }
+      finally source.close()
+    }
+  })
+  errorDrainer.setDaemon(true)
+  errorDrainer.start()
+
+  def isAlive: Boolean = process.isAlive()
+
+  /**
+   * Sends one request with its data and waits for the reply.  Throws an
+   * IOException if the process died or broke the protocol.
+   */
+  def request(command: Byte, data: Array[Byte]): Runtime2Worker.Reply = {
+    try {
+      toProcess.writeByte(command)
+      toProcess.writeInt(data.length)
+      toProcess.write(data)
+      toProcess.flush()
+
+      val status = fromProcess.readUnsignedByte()
+      val output = readFrame()
+      val messages = new String(readFrame(), StandardCharsets.UTF_8)
+      Runtime2Worker.Reply(status == Runtime2Worker.Ok, output, messages)
+    } catch {
+      case e: IOException =>
+        // Give the drainer a moment to read the rest of a dying process's stderr
+        errorDrainer.join(1000)
+        val stderr = errors.toString.trim
+        if (stderr.isEmpty) throw e
+        else throw new IOException(s"${e.getMessage} (daffodil serve stderr: $stderr)", e)
+    }
+  }
+
+  private def readFrame(): Array[Byte] = {
+    val length = fromProcess.readInt()
+    if (length < 0) throw new IOException(s"daffodil serve replied with invalid length $length")
+    val bytes = new Array[Byte](length)
+    fromProcess.readFully(bytes)
+    bytes
+  }
+
+  /**
+   * Closes the process's stdin, which tells it to exit, and makes sure it
+   * does exit.
+   */
+  def close(): Unit = {
+    try toProcess.close() catch { case _: IOException => }
+    if (!process.waitFor(1000)) process.destroyForcibly()
+    errorDrainer.join(1000)
+  }
+}
+
+object Runtime2Worker {
+  // Request commands and reply statuses of the serve protocol
+  val Parse: Byte = 'p'.toByte
+  val Unparse: Byte = 'u'.toByte
+  val Ok: Int = 0
+
+  final case class Reply(succeeded: Boolean, output: Array[Byte], messages: String)
+}
+
 object Runtime2DataLocation {
   class Runtime2DataLocation( _bitPos1b: Long,
                              _bytePos1b: Long) extends DataLocation {
@@ -172,17 +322,14 @@ object Runtime2DataLocation {
   }
 }
 
-final class ParseResult(outfile: os.Path,
+final class ParseResult(infoset: Array[Byte],
                         override val processorStatus: ProcessorResult,
-                        infile: os.Path)
+                        dataLengthInBytes: Long)
   extends DFDL.ParseResult
     with DFDL.State
     with WithDiagnosticsImpl {
 
-  val loc: DataLocation = {
-    val infileLengthInBytes = infile.toIO.length()
-    Runtime2DataLocation(infileLengthInBytes * 8, infileLengthInBytes)
-  }
+  val loc: DataLocation = Runtime2DataLocation(dataLengthInBytes * 8, dataLengthInBytes)
 
   override def resultState: DFDL.State = this
 
@@ -192,7 +339,7 @@ final class ParseResult(outfile: os.Path,
 
   override def currentLocation: DataLocation = loc
 
-  val infosetAsXML : scala.xml.Elem = scala.xml.XML.loadFile(outfile.toIO)
+  lazy val infosetAsXML : scala.xml.Elem = scala.xml.XML.load(new ByteArrayInputStream(infoset))
 }
 
 final class UnparseResult(val finalBitPos0b: Long,
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.apache.daffodil.runtime2
+
+import java.io.IOException
+import java.nio.ByteBuffer
+import java.nio.charset.StandardCharsets
+import java.util.concurrent.ConcurrentLinkedQueue
+
+/**
+ * Loads a shared library built by CodeGenerator.compileLibrary and parses
+ * or unparses in-process by calling its native methods (see daffodil_jni.c)
+ * with direct ByteBuffers, avoiding both starting a process and copying
+ * data through pipes.  Thread-safe; each thread gets its own runtime
+ * context and buffers.
+ */
+final class Runtime2Library(libraryFile: os.Path) {
+  System.load(libraryFile.toString)
+  private val library = openLibrary(libraryFile.toString)
+  if (library == 0L) throw new IOException(s"Unable to open shared library $libraryFile")
+
+  /**
+   * Holds one thread's runtime context and direct buffers, growing its
+   * buffers whenever a call needs bigger ones.
+   */
+  private final class ThreadState(val context: Long) {
+    var input: ByteBuffer = ByteBuffer.allocateDirect(Runtime2Library.InitialCapacity)
+    var output: ByteBuffer = ByteBuffer.allocateDirect(Runtime2Library.InitialCapacity)
+    val messages: ByteBuffer = ByteBuffer.allocateDirect(Runtime2Library.MessagesCapacity)
+    val lengths: Array[Long] = new Array[Long](2)
+  }
+
+  // Remembers every thread's context so close can free them all
+  private val contexts = new ConcurrentLinkedQueue[java.lang.Long]()
+
+  private val threadState = new ThreadLocal[ThreadState] {
+    override def initialValue(): ThreadState = {
+      val context = newContext(library)
+      if (context == 0L) throw new IOException(s"Unable to allocate runtime context in $libraryFile")
+      contexts.offer(context)
+      new ThreadState(context)
+    }
+  }
+
+  /**
+   * Parses inputLength bytes of the direct input buffer, writing an
+   * infosetType ("xml", "json", or "binary") infoset into the direct output
+   * buffer and any diagnostics into the direct messages buffer.  Sets
+   * lengths(0) to the output's length and lengths(1) to the messages'
+   * length.  Returns Runtime2Library.Ok, Error, or Full (the output needs
+   * a buffer with lengths(0) bytes).
+   */
+  def parse(infosetType: String, input: ByteBuffer, inputLength: Int, output: ByteBuffer, messages: ByteBuffer,
+            lengths: Array[Long]): Int =
+    parseBuffer(library, threadState.get.context, infosetType, input, inputLength, output, messages, lengths)
+
+  /**
+   * Unparses an infosetType infoset in inputLength bytes of the direct
+   * input buffer, writing the data into the direct output buffer, just
+   * like parse otherwise.
+   */
+  def unparse(infosetType: String, input: ByteBuffer, inputLength: Int, output: ByteBuffer, messages: ByteBuffer,
+              lengths: Array[Long]): Int =
+    unparseBuffer(library, threadState.get.context, infosetType, input, inputLength, output, messages, lengths)
+
+  /**
+   * Carries out one parse or unparse request with data in an XML infoset,
+   * the same requests which a Runtime2Worker sends to a "daffodil serve"
+   * process, copying data through this thread's buffers.  Requests stay in
+   * XML because their replies become a ParseResult, whose infosetAsXML is
+   * what TDML tests compare and unparse, and a Runtime2Worker can speak
+   * only XML.  Callers which don't need XML should call parse or unparse
+   * with "binary" instead, which skips formatting and scanning numbers as
+   * text.
+   */
+  def request(command: Byte, data: Array[Byte]): Runtime2Worker.Reply = {
+    val state = threadState.get
+    if (data.length > state.input.capacity) state.input = ByteBuffer.allocateDirect(data.length)
+    state.input.clear()
+    state.input.put(data)
+
+    def call(): Int =
+      if (command == Runtime2Worker.Parse)
+        parse("xml", state.input, data.length, state.output, state.messages, state.lengths)
+      else
+        unparse("xml", state.input, data.length, state.output, state.messages, state.lengths)
+
+    var status = call()
+    if (status == Runtime2Library.Full) {
+      state.output = ByteBuffer.allocateDirect(state.lengths(0).toInt)
+      status = call()
+    }
+
+    // Output didn't fit if a failed call needed more room than we have
+    val outputLength = if (state.lengths(0) <= state.output.capacity) state.lengths(0).toInt else 0
+    val output = new Array[Byte](outputLength)
+    state.output.clear()
+    state.output.get(output)
+    val messages = new Array[Byte](state.lengths(1).toInt)
+    state.messages.clear()
+    state.messages.get(messages)
+    Runtime2Worker.Reply(status == Runtime2Library.Ok, output, new String(messages, StandardCharsets.UTF_8))
+  }
+
+  /**
+   * Frees every thread's context and closes the shared library.  Don't call
+   * any other methods afterwards.
+   */
+  def close(): Unit = {
+    var context = contexts.poll()
+    while (context != null) {
+      freeContext(library, context)
+      context = contexts.poll()
+    }
+    closeLibrary(library)
+  }
+
+  // Native methods implemented in daffodil_jni.c
+  @native private[runtime2] def openLibrary(path: String): Long
+  @native private[runtime2] def closeLibrary(library: Long): Unit
+  @native private[runtime2] def newContext(library: Long): Long
+  @native private[runtime2] def freeContext(library: Long, context: Long): Unit
+  @native private[runtime2] def parseBuffer(library: Long, context: Long, infosetType: String, input: ByteBuffer,
+                                            inputLength: Int, output: ByteBuffer, messages: ByteBuffer,
+                                            lengths: Array[Long]): Int
+  @native private[runtime2] def unparseBuffer(library: Long, context: Long, infosetType: String, input: ByteBuffer,
+                                              inputLength: Int, output: ByteBuffer, messages: ByteBuffer,
+                                              lengths: Array[Long]): Int
+}
+
+object Runtime2Library {
+  // Statuses returned by parse and unparse (see LibraryStatus in library_api.h)
+  val Ok: Int = 0
+  val Error: Int = 1
+  val Full: Int = 2
+
+  // Initial sizes of each thread's buffers (messages are truncated to fit)
+  val InitialCapacity: Int = 64 * 1024
+  val MessagesCapacity: Int = 64 * 1024
+}
@@ -30,6 +30,7 @@ import org.apache.daffodil.exceptions.ThrowsSDE
 import org.apache.daffodil.schema.annotation.props.gen.OccursCountKind
 
 import java.net.URI
+import java.nio.charset.StandardCharsets
 import scala.collection.mutable
 
 /**
@@ -41,6 +42,7 @@ class CodeGeneratorState {
   private val erds = mutable.ArrayBuffer[String]()
   private val finalStructs = mutable.ArrayBuffer[String]()
   private val finalImplementation = mutable.ArrayBuffer[String]()
+  private var rootElementFixedLength = true
 
   // Builds an ERD name for the given element that needs to be unique in C file scope
   private def erdName(context: ElementBase): String = {
@@ -63,6 +65,11 @@ class CodeGeneratorState {
   // Returns the given element's local name (doesn't have to be unique)
   private def localName(context: ElementBase): String = context.namedQName.local
 
+  // Tells whether an element repeats as a fixed-size array, which lets
+  // infoset converters group its items the same way runtime1 does
+  private def isArrayInit(context: ElementBase): String =
+    if (context.isArray && context.occursCountKind == OccursCountKind.Fixed) "true" else "false"
+
   def addImplementation(context: ElementBase): Unit = {
     val C = localName(context)
     val initStatements = structs.top.initStatements.mkString("\n")
@@ -81,17 +88,26 @@ class CodeGeneratorState {
          |    UNUSED(${C}_compute_offsets);
          |    UNUSED(instance);
          |    UNUSED(ustate);""".stripMargin
+    flushNumberRun()
+    val walkerStatements = structs.top.walkerStatements.mkString("\n")
+    // Only choices and complex children need the context
+    val unusedContext = if (structs.top.walkerStatements.exists(_.contains("context")))
+      ""
+    else
+      "\n    UNUSED(context);"
     val hasChoice = structs.top.initChoiceStatements.nonEmpty
     val root = structs.elems.last.C
     val prototypeInitChoice = if (hasChoice)
-      s"\nstatic const Error *${C}_initChoice($C *instance, const $root *rootElement);"
+      s"\nstatic const Error *${C}_initChoice($C *instance, RuntimeContext *context);"
     else
       ""
     val implementInitChoice = if (hasChoice)
       s"""
          |static const Error *
-         |${C}_initChoice($C *instance, const $root *rootElement)
+         |${C}_initChoice($C *instance, RuntimeContext *context)
          |{
+         |    const $root *rootElement = (const $root *)context->root;
+         |
          |$initChoiceStatements
          |}
          |""".stripMargin
@@ -100,7 +116,8 @@ class CodeGeneratorState {
     val prototypeFunctions =
       s"""static void ${C}_initSelf($C *instance);$prototypeInitChoice
          |static void ${C}_parseSelf($C *instance, PState *pstate);
-         |static void ${C}_unparseSelf(const $C *instance, UState *ustate);""".stripMargin
+         |static void ${C}_unparseSelf(const $C *instance, UState *ustate);
+         |static const Error *${C}_walkSelf(const $C *instance, const VisitEventHandler *handler, RuntimeContext *context);""".stripMargin
     val functions =
       s"""static void
          |${C}_initSelf($C *instance)
@@ -119,6 +136,15 @@ class CodeGeneratorState {
          |{
          |$unparserStatements
          |}
+         |
+         |static const Error *
+         |${C}_walkSelf(const $C *instance, const VisitEventHandler *handler, RuntimeContext *context)
+         |{
+         |    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+         |    if (error) return error;$unusedContext
+         |$walkerStatements
+         |    return handler->visitEndComplex(handler, &instance->_base);
+         |}
          |""".stripMargin
 
     prototypes += prototypeFunctions
@@ -132,11 +158,23 @@ class CodeGeneratorState {
     // Optimize away ns declaration if possible, although this approach may not be entirely correct
     val parentNsUri = context.enclosingElements.headOption.map(_.namedQName.namespace.toStringOrNullIfNoNS).getOrElse("no-ns")
     val ns = if (nsUri == null || nsUri == parentNsUri) "NULL" else s""""$nsUri""""
+    // Precompute the qualified name and xmlns attribute so XML visitors don't build them at runtime
+    val name = context.namedQName.prefix.map(p => s"$p:$local").getOrElse(local)
+    val nameBytes = name.getBytes(StandardCharsets.UTF_8)
+    val nameLength = nameBytes.length
+    // Hash the qualified name with 32-bit FNV-1a exactly like xml_reader.c does
+    val nameHash = nameBytes.foldLeft(0x811c9dc5) { (hash, byte) => (hash ^ (byte & 0xff)) * 0x01000193 }
+    val nameHashHex = f"0x$nameHash%08xu"
+    val xmlns = if (ns == "NULL") "NULL" else context.namedQName.prefix.map(p => s""""xmlns:$p"""").getOrElse("\"xmlns\"")
     val qnameInit =
       s"""    {
          |        $prefix, // namedQName.prefix
          |        "$local", // namedQName.local
          |        $ns, // namedQName.ns
+         |        "$name", // namedQName.name
+         |        $nameLength, // namedQName.nameLength
+         |        $nameHashHex, // namedQName.nameHash
+         |        $xmlns, // namedQName.xmlns
          |    },""".stripMargin
     qnameInit
   }
@@ -193,6 +231,7 @@ class CodeGeneratorState {
 
     // Implement padding if complex type has an explicit length
     if (context.maybeFixedLengthInBits.isDefined && context.maybeFixedLengthInBits.get > 0) {
+      structs.top.hasFixedLength = true
       val lengthInBytes = context.maybeFixedLengthInBits.get / 8;
       val parseStatement = s"    const size_t end_position = pstate->position + $lengthInBytes;"
       val unparseStatement = s"    const size_t end_position = ustate->position + $lengthInBytes;"
@@ -203,6 +242,8 @@ class CodeGeneratorState {
 
     val dispatchField = choiceDispatchField(context)
     if (dispatchField.nonEmpty) {
+      // Choices make the root element's length vary unless they are padded to an explicit length
+      if (!structs.exists(_.hasFixedLength)) rootElementFixedLength = false
       val C = localName(context)
       val declaration =
         s"""    size_t      _choice; // choice of which union field to use
@@ -214,36 +255,41 @@ class CodeGeneratorState {
            |        NULL, // namedQName.prefix
            |        "_choice", // namedQName.local
            |        NULL, // namedQName.ns
+           |        "_choice", // namedQName.name
+           |        7, // namedQName.nameLength
+           |        0x764267cdu, // namedQName.nameHash
+           |        NULL, // namedQName.xmlns
            |    },
            |    CHOICE, // typeCode
-           |    0, NULL, NULL, NULL, NULL, NULL, NULL
+           |    false, // isArray
+           |    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
            |};
            |""".stripMargin
       val offsetComputation = s"    (const char *)&${C}_compute_offsets._choice - (const char *)&${C}_compute_offsets"
       val erdComputation = s"    &_choice_$erd"
       val initStatement = s"    instance->_choice = 0xFFFFFFFFFFFFFFFF;"
       val initChoiceStatement =
-        s"""    static Error error = {ERR_CHOICE_KEY, {0}};
-           |
-           |    int64_t key = rootElement->$dispatchField;
+        s"""    int64_t key = rootElement->$dispatchField;
            |    switch (key)
            |    {""".stripMargin
       val parseStatement =
-        s"""    static Error error = {ERR_CHOICE_KEY, {0}};
-           |
-           |    pstate->error = instance->_base.erd->initChoice(&instance->_base, rootElement());
+        s"""    pstate->error = instance->_base.erd->initChoice(&instance->_base, pstate->context);
            |    if (pstate->error) return;
            |
            |    switch (instance->_choice)
            |    {""".stripMargin
       val unparseStatement =
-        s"""    static Error error = {ERR_CHOICE_KEY, {0}};
-           |
-           |    ustate->error = instance->_base.erd->initChoice(&instance->_base, rootElement());
+        s"""    ustate->error = instance->_base.erd->initChoice(&instance->_base, ustate->context);
            |    if (ustate->error) return;
            |
            |    switch (instance->_choice)
            |    {""".stripMargin
+      val walkerStatement =
+        s"""    error = instance->_base.erd->initChoice(&instance->_base, context);
+           |    if (error) return error;
+           |
+           |    switch (instance->_choice)
+           |    {""".stripMargin
 
       erds += erdDef
       structs.top.declarations += declaration
@@ -253,6 +299,7 @@ class CodeGeneratorState {
       structs.top.initChoiceStatements += initChoiceStatement
       structs.top.parserStatements += parseStatement
       structs.top.unparserStatements += unparseStatement
+      addWalkerStatement(walkerStatement)
     }
   }
 
@@ -263,8 +310,9 @@ class CodeGeneratorState {
       val declaration = s"    };"
       val initChoiceStatement =
         s"""    default:
-           |        error.arg.d64 = key;
-           |        return &error;
+           |        context->error.code = ERR_CHOICE_KEY;
+           |        context->error.arg.d64 = key;
+           |        return &context->error;
            |    }
            |
            |    // Point next ERD to choice of alternative elements' ERDs
@@ -278,22 +326,32 @@ class CodeGeneratorState {
       val parseStatement =
         s"""    default:
            |        // Should never happen because initChoice would return an error first
-           |        error.arg.d64 = (int64_t)instance->_choice;
-           |        pstate->error = &error;
+           |        pstate->context->error.code = ERR_CHOICE_KEY;
+           |        pstate->context->error.arg.d64 = (int64_t)instance->_choice;
+           |        pstate->error = &pstate->context->error;
            |        return;
            |    }""".stripMargin
       val unparseStatement =
         s"""    default:
            |        // Should never happen because initChoice would return an error first
-           |        error.arg.d64 = (int64_t)instance->_choice;
-           |        ustate->error = &error;
+           |        ustate->context->error.code = ERR_CHOICE_KEY;
+           |        ustate->context->error.arg.d64 = (int64_t)instance->_choice;
+           |        ustate->error = &ustate->context->error;
            |        return;
            |    }""".stripMargin
+      val walkerStatement =
+        s"""    default:
+           |        // Should never happen because initChoice would return an error first
+           |        context->error.code = ERR_CHOICE_KEY;
+           |        context->error.arg.d64 = (int64_t)instance->_choice;
+           |        return &context->error;
+           |    }""".stripMargin
 
       structs.top.declarations += declaration
       structs.top.initChoiceStatements += initChoiceStatement
       structs.top.parserStatements += parseStatement
       structs.top.unparserStatements += unparseStatement
+      addWalkerStatement(walkerStatement)
     }
 
     // Implement padding if complex type has an explicit length
@@ -335,12 +393,14 @@ class CodeGeneratorState {
          |static const ERD $erd = {
          |$qnameInit
          |    COMPLEX, // typeCode
+         |    ${isArrayInit(context)}, // isArray
          |    $numChildren, // numChildren
          |    ${C}_offsets, // offsets
          |    ${C}_childrenERDs, // childrenERDs
          |    (ERDInitSelf)&${C}_initSelf, // initSelf
          |    (ERDParseSelf)&${C}_parseSelf, // parseSelf
          |    (ERDUnparseSelf)&${C}_unparseSelf, // unparseSelf
+         |    (ERDWalkSelf)&${C}_walkSelf, // walkSelf
          |    $initChoice // initChoice
          |};
          |""".stripMargin
@@ -381,12 +441,14 @@ class CodeGeneratorState {
            |        break;""".stripMargin
       val parseStatement = s"    case $offset:"
       val unparseStatement = s"    case $offset:"
+      val walkerStatement = s"    case $offset:"
 
       structs.top.initChoiceStatements ++= ChoiceBranchKeyCooker.convertConstant(
         child.choiceBranchKey, child, forUnparse = false).map { key => s"    case $key:"}
       structs.top.initChoiceStatements += initChoiceStatement
       structs.top.parserStatements += parseStatement
       structs.top.unparserStatements += unparseStatement
+      addWalkerStatement(walkerStatement)
     }
 
     def addStatements(deref: String): Unit = {
@@ -398,10 +460,14 @@ class CodeGeneratorState {
       val unparseStatement =
         s"""$moreIndent    ${C}_unparseSelf(&instance->$e$deref, ustate);
            |$moreIndent    if (ustate->error) return;""".stripMargin
+      val walkerStatement =
+        s"""$moreIndent    error = ${C}_walkSelf(&instance->$e$deref, handler, context);
+           |$moreIndent    if (error) return error;""".stripMargin
 
       structs.top.initStatements += initStatement
       structs.top.parserStatements += parseStatement
       structs.top.unparserStatements += unparseStatement
+      addWalkerStatement(walkerStatement)
     }
     if (arraySize > 0)
       for (i <- 0 until arraySize)
@@ -412,9 +478,11 @@ class CodeGeneratorState {
     if (hasChoice) {
       val parseStatement = s"        break;"
       val unparseStatement = s"        break;"
+      val walkerStatement = s"        break;"
 
       structs.top.parserStatements += parseStatement
       structs.top.unparserStatements += unparseStatement
+      addWalkerStatement(walkerStatement)
     }
   }
 
@@ -500,11 +568,72 @@ class CodeGeneratorState {
       s"""static const ERD $erd = {
          |$qnameInit
          |    $typeCode, // typeCode
-         |    0, NULL, NULL, NULL, NULL, NULL, NULL
+         |    ${isArrayInit(context)}, // isArray
+         |    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
          |};
          |""".stripMargin
     erds += erdDef
     addComputations(context)
+    addSimpleTypeWalkerStatements(context, typeCode)
+  }
+
+  // Adds a statement to walkSelf after visiting any pending run of simple elements
+  private def addWalkerStatement(walkerStatement: String): Unit = {
+    flushNumberRun()
+    structs.top.walkerStatements += walkerStatement
+  }
+
+  // Visits a simple element with its ERD, extending the pending run of
+  // simple elements instead if it has the same type and follows the run
+  private def addSimpleTypeWalkerStatements(child: ElementBase, typeCode: String): Unit = {
+    val top = structs.top
+    val e = localName(child)
+    val erd = erdName(child)
+    val arraySize = if (child.occursCountKind == OccursCountKind.Fixed) child.maxOccurs else 0
+    val count = if (arraySize > 0) arraySize else 1
+    val first = top.offsetComputations.length - count
+    for (i <- 0 until count) {
+      val deref = if (arraySize > 0) s"[$i]" else ""
+      if (top.runCount > 0 && top.runTypeCode == typeCode && top.runStart + top.runCount == first + i) {
+        top.runCount += 1
+      } else {
+        flushNumberRun()
+        top.runTypeCode = typeCode
+        top.runStart = first + i
+        top.runCount = 1
+        top.runFirstERD = erd
+        top.runFirstField = s"$e$deref"
+      }
+    }
+  }
+
+  // Visits the pending run of simple elements, passing runs longer than
+  // one element to walkNumberRun with their span of childrenERDs
+  private def flushNumberRun(): Unit = {
+    val top = structs.top
+    if (top.runCount == 1) {
+      val call = s"    error = handler->visitNumberElem(handler, &${top.runFirstERD}, &instance->${top.runFirstField});"
+      top.walkerStatements +=
+        s"""${wrapCall(call)}
+           |    if (error) return error;""".stripMargin
+    } else if (top.runCount > 1) {
+      val call = s"    error = walkNumberRun(handler, &${top.C}_childrenERDs[${top.runStart}], &instance->${top.runFirstField}, ${top.runCount});"
+      top.walkerStatements +=
+        s"""${wrapCall(call)}
+           |    if (error) return error;""".stripMargin
+    }
+    top.runCount = 0
+  }
+
+  // Wraps a call statement's arguments at 110 columns the way clang-format
+  // does, continuing them under the character after the call's open paren
+  private def wrapCall(call: String, align: Int = -1): String = {
+    val column = if (align < 0) call.indexOf('(') + 1 else align
+    val cut = call.lastIndexOf(", ", 109)
+    if (call.length <= 110 || cut < column)
+      call
+    else
+      call.substring(0, cut + 1) + "\n" + wrapCall(" " * column + call.substring(cut + 2), column)
   }
 
   def addComputations(child: ElementBase): Unit = {
@@ -582,6 +711,7 @@ class CodeGeneratorState {
          |#include <math.h>       // for NAN
          |#include <stdbool.h>    // for bool, true, false
          |#include <stddef.h>     // for NULL, size_t
+         |#include <stdlib.h>     // for malloc
          |#include "errors.h"     // for Error, PState, UState, ERR_CHOICE_KEY, UNUSED
          |#include "parsers.h"    // for parse_be_float, parse_be_int16, parse_be_bool32, parse_validate_fixed, parse_be_bool16, parse_be_int32, parse_be_uint32, parse_le_bool32, parse_le_int64, parse_le_uint8, parse_be_bool8, parse_be_double, parse_be_int64, parse_be_int8, parse_be_uint16, parse_be_uint64, parse_be_uint8, parse_le_bool16, parse_le_bool8, parse_le_double, parse_le_float, parse_le_int16, parse_le_int32, parse_le_int8, parse_le_uint16, parse_le_uint32, parse_le_uint64
          |#include "unparsers.h"  // for unparse_be_float, unparse_be_int16, unparse_be_bool32, unparse_validate_fixed, unparse_be_bool16, unparse_be_int32, unparse_be_uint32, unparse_le_bool32, unparse_le_int64, unparse_le_uint8, unparse_be_bool8, unparse_be_double, unparse_be_int64, unparse_be_int8, unparse_be_uint16, unparse_be_uint64, unparse_be_uint8, unparse_le_bool16, unparse_le_bool8, unparse_le_double, unparse_le_float, unparse_le_int16, unparse_le_int32, unparse_le_int8, unparse_le_uint16, unparse_le_uint32, unparse_le_uint64
@@ -597,22 +727,26 @@ class CodeGeneratorState {
          |// Define metadata for the infoset
          |
          |$erds
-         |// Return a root element for parsing or unparsing the infoset
+         |// Return a new root element for parsing or unparsing the infoset
+         |// (caller owns it and must free it)
          |
          |InfosetBase *
          |rootElement(void)
          |{
-         |    static bool initialized;
-         |    static $rootElementName root;
-         |    if (!initialized)
+         |    $rootElementName *root = malloc(sizeof($rootElementName));
+         |    if (root)
          |    {
-         |        ${rootElementName}_initSelf(&root);
-         |        initialized = true;
+         |        ${rootElementName}_initSelf(root);
+         |        return &root->_base;
          |    }
-         |    return &root._base;
+         |    return NULL;
          |}
          |
-         |// Initialize, parse, and unparse nodes of the infoset
+         |// Tell callers whether every root element parses the same number of bytes
+         |
+         |const bool rootElementFixedLength = $rootElementFixedLength;
+         |
+         |// Initialize, parse, unparse, and walk nodes of the infoset
          |
          |$finalImplementation
          |""".stripMargin
@@ -625,6 +759,7 @@ class CodeGeneratorState {
  * complex elements.
  */
 class ComplexCGState(val C: String) {
+  var hasFixedLength = false
   val declarations = mutable.ArrayBuffer[String]()
   val offsetComputations = mutable.ArrayBuffer[String]()
   val erdComputations = mutable.ArrayBuffer[String]()
@@ -632,4 +767,11 @@ class ComplexCGState(val C: String) {
   val initChoiceStatements = mutable.ArrayBuffer[String]()
   val parserStatements = mutable.ArrayBuffer[String]()
   val unparserStatements = mutable.ArrayBuffer[String]()
+  val walkerStatements = mutable.ArrayBuffer[String]()
+  // Pending run of adjacent simple elements of the same type for walkSelf to visit at once
+  var runTypeCode = ""
+  var runStart = 0
+  var runCount = 0
+  var runFirstERD = ""
+  var runFirstField = ""
 }
@@ -43,7 +43,7 @@ trait ElementParseAndUnspecifiedLengthCodeGenerator {
       cgState.addBeforeSwitchStatements(context) // switch statements for choices
       context.elementChildren.foreach { child =>
         if (!child.isSimpleType) {
-          cgState.addComplexTypeStatements(child) // recursive calls to parse, unparse, init
+          cgState.addComplexTypeStatements(child) // recursive calls to parse, unparse, init, walk
           cgState.addComputations(child) // offset, ERD computations
         }
         cgState.addFieldDeclaration(context, child) // struct member for child
@@ -51,7 +51,7 @@ trait ElementParseAndUnspecifiedLengthCodeGenerator {
       }
       cgState.addAfterSwitchStatements(context) // switch statements for choices
       cgState.addStruct(context) // struct definition
-      cgState.addImplementation(context) // initSelf, parseSelf, unparseSelf
+      cgState.addImplementation(context) // initSelf, parseSelf, unparseSelf, walkSelf
       cgState.addComplexTypeERD(context) // ERD static initializer
       cgState.popComplexElement()
     }
@@ -2,6 +2,7 @@
 #include <math.h>       // for NAN
 #include <stdbool.h>    // for bool, true, false
 #include <stddef.h>     // for NULL, size_t
+#include <stdlib.h>     // for malloc
 #include "errors.h"     // for Error, PState, UState, ERR_CHOICE_KEY, UNUSED
 #include "parsers.h"    // for parse_be_float, parse_be_int16, parse_be_bool32, parse_validate_fixed, parse_be_bool16, parse_be_int32, parse_be_uint32, parse_le_bool32, parse_le_int64, parse_le_uint8, parse_be_bool8, parse_be_double, parse_be_int64, parse_be_int8, parse_be_uint16, parse_be_uint64, parse_be_uint8, parse_le_bool16, parse_le_bool8, parse_le_double, parse_le_float, parse_le_int16, parse_le_int32, parse_le_int8, parse_le_uint16, parse_le_uint32, parse_le_uint64
 #include "unparsers.h"  // for unparse_be_float, unparse_be_int16, unparse_be_bool32, unparse_validate_fixed, unparse_be_bool16, unparse_be_int32, unparse_be_uint32, unparse_le_bool32, unparse_le_int64, unparse_le_uint8, unparse_be_bool8, unparse_be_double, unparse_be_int64, unparse_be_int8, unparse_be_uint16, unparse_be_uint64, unparse_be_uint8, unparse_le_bool16, unparse_le_bool8, unparse_le_double, unparse_le_float, unparse_le_int16, unparse_le_int32, unparse_le_int8, unparse_le_uint16, unparse_le_uint32, unparse_le_uint64
@@ -15,16 +16,20 @@ const char *daffodil_program_version = "daffodil-runtime2 3.1.0";
 static void foo_initSelf(foo *instance);
 static void foo_parseSelf(foo *instance, PState *pstate);
 static void foo_unparseSelf(const foo *instance, UState *ustate);
+static const Error *foo_walkSelf(const foo *instance, const VisitEventHandler *handler, RuntimeContext *context);
 static void bar_initSelf(bar *instance);
 static void bar_parseSelf(bar *instance, PState *pstate);
 static void bar_unparseSelf(const bar *instance, UState *ustate);
+static const Error *bar_walkSelf(const bar *instance, const VisitEventHandler *handler, RuntimeContext *context);
 static void data_initSelf(data *instance);
-static const Error *data_initChoice(data *instance, const NestedUnion *rootElement);
+static const Error *data_initChoice(data *instance, RuntimeContext *context);
 static void data_parseSelf(data *instance, PState *pstate);
 static void data_unparseSelf(const data *instance, UState *ustate);
+static const Error *data_walkSelf(const data *instance, const VisitEventHandler *handler, RuntimeContext *context);
 static void NestedUnion_initSelf(NestedUnion *instance);
 static void NestedUnion_parseSelf(NestedUnion *instance, PState *pstate);
 static void NestedUnion_unparseSelf(const NestedUnion *instance, UState *ustate);
+static const Error *NestedUnion_walkSelf(const NestedUnion *instance, const VisitEventHandler *handler, RuntimeContext *context);
 
 // Define metadata for the infoset
 
@@ -33,9 +38,14 @@ static const ERD tag_NestedUnionType_ERD = {
         NULL, // namedQName.prefix
         "tag", // namedQName.local
         NULL, // namedQName.ns
+        "tag", // namedQName.name
+        3, // namedQName.nameLength
+        0x95f72993u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD _choice_data_NestedUnionType_ERD = {
@@ -43,9 +53,14 @@ static const ERD _choice_data_NestedUnionType_ERD = {
         NULL, // namedQName.prefix
         "_choice", // namedQName.local
         NULL, // namedQName.ns
+        "_choice", // namedQName.name
+        7, // namedQName.nameLength
+        0x764267cdu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     CHOICE, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD a_FooType_ERD = {
@@ -53,9 +68,14 @@ static const ERD a_FooType_ERD = {
         NULL, // namedQName.prefix
         "a", // namedQName.local
         NULL, // namedQName.ns
+        "a", // namedQName.name
+        1, // namedQName.nameLength
+        0xe40c292cu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD b_FooType_ERD = {
@@ -63,9 +83,14 @@ static const ERD b_FooType_ERD = {
         NULL, // namedQName.prefix
         "b", // namedQName.local
         NULL, // namedQName.ns
+        "b", // namedQName.name
+        1, // namedQName.nameLength
+        0xe70c2de5u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD c_FooType_ERD = {
@@ -73,9 +98,14 @@ static const ERD c_FooType_ERD = {
         NULL, // namedQName.prefix
         "c", // namedQName.local
         NULL, // namedQName.ns
+        "c", // namedQName.name
+        1, // namedQName.nameLength
+        0xe60c2c52u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const foo foo_compute_offsets;
@@ -97,14 +127,20 @@ static const ERD foo_data_NestedUnionType_ERD = {
         NULL, // namedQName.prefix
         "foo", // namedQName.local
         NULL, // namedQName.ns
+        "foo", // namedQName.name
+        3, // namedQName.nameLength
+        0xa9f37ed7u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     3, // numChildren
     foo_offsets, // offsets
     foo_childrenERDs, // childrenERDs
     (ERDInitSelf)&foo_initSelf, // initSelf
     (ERDParseSelf)&foo_parseSelf, // parseSelf
     (ERDUnparseSelf)&foo_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&foo_walkSelf, // walkSelf
     NULL // initChoice
 };
 
@@ -113,9 +149,14 @@ static const ERD x_BarType_ERD = {
         NULL, // namedQName.prefix
         "x", // namedQName.local
         NULL, // namedQName.ns
+        "x", // namedQName.name
+        1, // namedQName.nameLength
+        0xfd0c5087u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_DOUBLE, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD y_BarType_ERD = {
@@ -123,9 +164,14 @@ static const ERD y_BarType_ERD = {
         NULL, // namedQName.prefix
         "y", // namedQName.local
         NULL, // namedQName.ns
+        "y", // namedQName.name
+        1, // namedQName.nameLength
+        0xfc0c4ef4u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_DOUBLE, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD z_BarType_ERD = {
@@ -133,9 +179,14 @@ static const ERD z_BarType_ERD = {
         NULL, // namedQName.prefix
         "z", // namedQName.local
         NULL, // namedQName.ns
+        "z", // namedQName.name
+        1, // namedQName.nameLength
+        0xff0c53adu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_DOUBLE, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const bar bar_compute_offsets;
@@ -157,14 +208,20 @@ static const ERD bar_data_NestedUnionType_ERD = {
         NULL, // namedQName.prefix
         "bar", // namedQName.local
         NULL, // namedQName.ns
+        "bar", // namedQName.name
+        3, // namedQName.nameLength
+        0x76b77d1au, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     3, // numChildren
     bar_offsets, // offsets
     bar_childrenERDs, // childrenERDs
     (ERDInitSelf)&bar_initSelf, // initSelf
     (ERDParseSelf)&bar_parseSelf, // parseSelf
     (ERDUnparseSelf)&bar_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&bar_walkSelf, // walkSelf
     NULL // initChoice
 };
 
@@ -187,14 +244,20 @@ static const ERD data_NestedUnionType_ERD = {
         NULL, // namedQName.prefix
         "data", // namedQName.local
         NULL, // namedQName.ns
+        "data", // namedQName.name
+        4, // namedQName.nameLength
+        0xd872e2a5u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     2, // numChildren
     data_offsets, // offsets
     data_childrenERDs, // childrenERDs
     (ERDInitSelf)&data_initSelf, // initSelf
     (ERDParseSelf)&data_parseSelf, // parseSelf
     (ERDUnparseSelf)&data_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&data_walkSelf, // walkSelf
     (InitChoiceRD)&data_initChoice // initChoice
 };
 
@@ -215,33 +278,43 @@ static const ERD NestedUnion_ERD = {
         "idl", // namedQName.prefix
         "NestedUnion", // namedQName.local
         "urn:idl:1.0", // namedQName.ns
+        "idl:NestedUnion", // namedQName.name
+        15, // namedQName.nameLength
+        0x9ff4b144u, // namedQName.nameHash
+        "xmlns:idl", // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     2, // numChildren
     NestedUnion_offsets, // offsets
     NestedUnion_childrenERDs, // childrenERDs
     (ERDInitSelf)&NestedUnion_initSelf, // initSelf
     (ERDParseSelf)&NestedUnion_parseSelf, // parseSelf
     (ERDUnparseSelf)&NestedUnion_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&NestedUnion_walkSelf, // walkSelf
     NULL // initChoice
 };
 
-// Return a root element for parsing or unparsing the infoset
+// Return a new root element for parsing or unparsing the infoset
+// (caller owns it and must free it)
 
 InfosetBase *
 rootElement(void)
 {
-    static bool initialized;
-    static NestedUnion root;
-    if (!initialized)
+    NestedUnion *root = malloc(sizeof(NestedUnion));
+    if (root)
     {
-        NestedUnion_initSelf(&root);
-        initialized = true;
+        NestedUnion_initSelf(root);
+        return &root->_base;
     }
-    return &root._base;
+    return NULL;
 }
 
-// Initialize, parse, and unparse nodes of the infoset
+// Tell callers whether every root element parses the same number of bytes
+
+const bool rootElementFixedLength = false;
+
+// Initialize, parse, unparse, and walk nodes of the infoset
 
 static void
 foo_initSelf(foo *instance)
@@ -274,6 +347,17 @@ foo_unparseSelf(const foo *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+foo_walkSelf(const foo *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    UNUSED(context);
+    error = walkNumberRun(handler, &foo_childrenERDs[0], &instance->a, 3);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
 static void
 bar_initSelf(bar *instance)
 {
@@ -305,6 +389,17 @@ bar_unparseSelf(const bar *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+bar_walkSelf(const bar *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    UNUSED(context);
+    error = walkNumberRun(handler, &bar_childrenERDs[0], &instance->x, 3);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
 static void
 data_initSelf(data *instance)
 {
@@ -315,9 +410,9 @@ data_initSelf(data *instance)
 }
 
 static const Error *
-data_initChoice(data *instance, const NestedUnion *rootElement)
+data_initChoice(data *instance, RuntimeContext *context)
 {
-    static Error error = {ERR_CHOICE_KEY, {0}};
+    const NestedUnion *rootElement = (const NestedUnion *)context->root;
 
     int64_t key = rootElement->tag;
     switch (key)
@@ -331,8 +426,9 @@ data_initChoice(data *instance, const NestedUnion *rootElement)
         instance->_choice = 1;
         break;
     default:
-        error.d64 = key;
-        return &error;
+        context->error.code = ERR_CHOICE_KEY;
+        context->error.arg.d64 = key;
+        return &context->error;
     }
 
     // Point next ERD to choice of alternative elements' ERDs
@@ -348,9 +444,7 @@ data_initChoice(data *instance, const NestedUnion *rootElement)
 static void
 data_parseSelf(data *instance, PState *pstate)
 {
-    static Error error = {ERR_CHOICE_KEY, {0}};
-
-    pstate->error = instance->_base.erd->initChoice(&instance->_base, rootElement());
+    pstate->error = instance->_base.erd->initChoice(&instance->_base, pstate->context);
     if (pstate->error) return;
 
     switch (instance->_choice)
@@ -365,8 +459,9 @@ data_parseSelf(data *instance, PState *pstate)
         break;
     default:
         // Should never happen because initChoice would return an error first
-        error.d64 = (int64_t)instance->_choice;
-        pstate->error = &error;
+        pstate->context->error.code = ERR_CHOICE_KEY;
+        pstate->context->error.arg.d64 = (int64_t)instance->_choice;
+        pstate->error = &pstate->context->error;
         return;
     }
 }
@@ -374,9 +469,7 @@ data_parseSelf(data *instance, PState *pstate)
 static void
 data_unparseSelf(const data *instance, UState *ustate)
 {
-    static Error error = {ERR_CHOICE_KEY, {0}};
-
-    ustate->error = instance->_base.erd->initChoice(&instance->_base, rootElement());
+    ustate->error = instance->_base.erd->initChoice(&instance->_base, ustate->context);
     if (ustate->error) return;
 
     switch (instance->_choice)
@@ -391,12 +484,40 @@ data_unparseSelf(const data *instance, UState *ustate)
         break;
     default:
         // Should never happen because initChoice would return an error first
-        error.d64 = (int64_t)instance->_choice;
-        ustate->error = &error;
+        ustate->context->error.code = ERR_CHOICE_KEY;
+        ustate->context->error.arg.d64 = (int64_t)instance->_choice;
+        ustate->error = &ustate->context->error;
         return;
     }
 }
 
+static const Error *
+data_walkSelf(const data *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    error = instance->_base.erd->initChoice(&instance->_base, context);
+    if (error) return error;
+
+    switch (instance->_choice)
+    {
+    case 0:
+        error = foo_walkSelf(&instance->foo, handler, context);
+        if (error) return error;
+        break;
+    case 1:
+        error = bar_walkSelf(&instance->bar, handler, context);
+        if (error) return error;
+        break;
+    default:
+        // Should never happen because initChoice would return an error first
+        context->error.code = ERR_CHOICE_KEY;
+        context->error.arg.d64 = (int64_t)instance->_choice;
+        return &context->error;
+    }
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
 static void
 NestedUnion_initSelf(NestedUnion *instance)
 {
@@ -423,3 +544,15 @@ NestedUnion_unparseSelf(const NestedUnion *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+NestedUnion_walkSelf(const NestedUnion *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &tag_NestedUnionType_ERD, &instance->tag);
+    if (error) return error;
+    error = data_walkSelf(&instance->data, handler, context);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
@@ -2,6 +2,7 @@
 #include <math.h>       // for NAN
 #include <stdbool.h>    // for bool, true, false
 #include <stddef.h>     // for NULL, size_t
+#include <stdlib.h>     // for malloc
 #include "errors.h"     // for Error, PState, UState, ERR_CHOICE_KEY, UNUSED
 #include "parsers.h"    // for parse_be_float, parse_be_int16, parse_be_bool32, parse_validate_fixed, parse_be_bool16, parse_be_int32, parse_be_uint32, parse_le_bool32, parse_le_int64, parse_le_uint8, parse_be_bool8, parse_be_double, parse_be_int64, parse_be_int8, parse_be_uint16, parse_be_uint64, parse_be_uint8, parse_le_bool16, parse_le_bool8, parse_le_double, parse_le_float, parse_le_int16, parse_le_int32, parse_le_int8, parse_le_uint16, parse_le_uint32, parse_le_uint64
 #include "unparsers.h"  // for unparse_be_float, unparse_be_int16, unparse_be_bool32, unparse_validate_fixed, unparse_be_bool16, unparse_be_int32, unparse_be_uint32, unparse_le_bool32, unparse_le_int64, unparse_le_uint8, unparse_be_bool8, unparse_be_double, unparse_be_int64, unparse_be_int8, unparse_be_uint16, unparse_be_uint64, unparse_be_uint8, unparse_le_bool16, unparse_le_bool8, unparse_le_double, unparse_le_float, unparse_le_int16, unparse_le_int32, unparse_le_int8, unparse_le_uint16, unparse_le_uint32, unparse_le_uint64
@@ -15,18 +16,23 @@ const char *daffodil_program_version = "daffodil-runtime2 3.1.0";
 static void array_initSelf(array *instance);
 static void array_parseSelf(array *instance, PState *pstate);
 static void array_unparseSelf(const array *instance, UState *ustate);
+static const Error *array_walkSelf(const array *instance, const VisitEventHandler *handler, RuntimeContext *context);
 static void bigEndian_initSelf(bigEndian *instance);
 static void bigEndian_parseSelf(bigEndian *instance, PState *pstate);
 static void bigEndian_unparseSelf(const bigEndian *instance, UState *ustate);
+static const Error *bigEndian_walkSelf(const bigEndian *instance, const VisitEventHandler *handler, RuntimeContext *context);
 static void littleEndian_initSelf(littleEndian *instance);
 static void littleEndian_parseSelf(littleEndian *instance, PState *pstate);
 static void littleEndian_unparseSelf(const littleEndian *instance, UState *ustate);
+static const Error *littleEndian_walkSelf(const littleEndian *instance, const VisitEventHandler *handler, RuntimeContext *context);
 static void fixed_initSelf(fixed *instance);
 static void fixed_parseSelf(fixed *instance, PState *pstate);
 static void fixed_unparseSelf(const fixed *instance, UState *ustate);
+static const Error *fixed_walkSelf(const fixed *instance, const VisitEventHandler *handler, RuntimeContext *context);
 static void ex_nums_initSelf(ex_nums *instance);
 static void ex_nums_parseSelf(ex_nums *instance, PState *pstate);
 static void ex_nums_unparseSelf(const ex_nums *instance, UState *ustate);
+static const Error *ex_nums_walkSelf(const ex_nums *instance, const VisitEventHandler *handler, RuntimeContext *context);
 
 // Define metadata for the infoset
 
@@ -35,9 +41,14 @@ static const ERD be_bool16_array_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_bool16", // namedQName.local
         NULL, // namedQName.ns
+        "be_bool16", // namedQName.name
+        9, // namedQName.nameLength
+        0x31c8e38eu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    true, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_float_array_ex_nums_ERD = {
@@ -45,9 +56,14 @@ static const ERD be_float_array_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_float", // namedQName.local
         NULL, // namedQName.ns
+        "be_float", // namedQName.name
+        8, // namedQName.nameLength
+        0xe109b35du, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_FLOAT, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    true, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_int16_array_ex_nums_ERD = {
@@ -55,9 +71,14 @@ static const ERD be_int16_array_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_int16", // namedQName.local
         NULL, // namedQName.ns
+        "be_int16", // namedQName.name
+        8, // namedQName.nameLength
+        0xbd09bda9u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT16, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    true, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const array array_compute_offsets;
@@ -89,14 +110,20 @@ static const ERD array_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "array", // namedQName.local
         NULL, // namedQName.ns
+        "array", // namedQName.name
+        5, // namedQName.nameLength
+        0x8a58ad26u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     8, // numChildren
     array_offsets, // offsets
     array_childrenERDs, // childrenERDs
     (ERDInitSelf)&array_initSelf, // initSelf
     (ERDParseSelf)&array_parseSelf, // parseSelf
     (ERDUnparseSelf)&array_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&array_walkSelf, // walkSelf
     NULL // initChoice
 };
 
@@ -105,9 +132,14 @@ static const ERD be_bool16_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_bool16", // namedQName.local
         NULL, // namedQName.ns
+        "be_bool16", // namedQName.name
+        9, // namedQName.nameLength
+        0x31c8e38eu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_bool32_bigEndian_ex_nums_ERD = {
@@ -115,9 +147,14 @@ static const ERD be_bool32_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_bool32", // namedQName.local
         NULL, // namedQName.ns
+        "be_bool32", // namedQName.name
+        9, // namedQName.nameLength
+        0x1dcd4140u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_bool8_bigEndian_ex_nums_ERD = {
@@ -125,9 +162,14 @@ static const ERD be_bool8_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_bool8", // namedQName.local
         NULL, // namedQName.ns
+        "be_bool8", // namedQName.name
+        8, // namedQName.nameLength
+        0x9a9b8cf7u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_boolean_bigEndian_ex_nums_ERD = {
@@ -135,9 +177,14 @@ static const ERD be_boolean_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_boolean", // namedQName.local
         NULL, // namedQName.ns
+        "be_boolean", // namedQName.name
+        10, // namedQName.nameLength
+        0x945de457u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_double_bigEndian_ex_nums_ERD = {
@@ -145,9 +192,14 @@ static const ERD be_double_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_double", // namedQName.local
         NULL, // namedQName.ns
+        "be_double", // namedQName.name
+        9, // namedQName.nameLength
+        0xd4905270u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_DOUBLE, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_float_bigEndian_ex_nums_ERD = {
@@ -155,9 +207,14 @@ static const ERD be_float_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_float", // namedQName.local
         NULL, // namedQName.ns
+        "be_float", // namedQName.name
+        8, // namedQName.nameLength
+        0xe109b35du, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_FLOAT, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_int16_bigEndian_ex_nums_ERD = {
@@ -165,9 +222,14 @@ static const ERD be_int16_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_int16", // namedQName.local
         NULL, // namedQName.ns
+        "be_int16", // namedQName.name
+        8, // namedQName.nameLength
+        0xbd09bda9u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT16, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_int32_bigEndian_ex_nums_ERD = {
@@ -175,9 +237,14 @@ static const ERD be_int32_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_int32", // namedQName.local
         NULL, // namedQName.ns
+        "be_int32", // namedQName.name
+        8, // namedQName.nameLength
+        0x51049677u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_int64_bigEndian_ex_nums_ERD = {
@@ -185,9 +252,14 @@ static const ERD be_int64_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_int64", // namedQName.local
         NULL, // namedQName.ns
+        "be_int64", // namedQName.name
+        8, // namedQName.nameLength
+        0xb8f86e3cu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT64, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_int8_bigEndian_ex_nums_ERD = {
@@ -195,9 +267,14 @@ static const ERD be_int8_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_int8", // namedQName.local
         NULL, // namedQName.ns
+        "be_int8", // namedQName.name
+        7, // namedQName.nameLength
+        0xa242c46au, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT8, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_integer16_bigEndian_ex_nums_ERD = {
@@ -205,9 +282,14 @@ static const ERD be_integer16_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_integer16", // namedQName.local
         NULL, // namedQName.ns
+        "be_integer16", // namedQName.name
+        12, // namedQName.nameLength
+        0x0e1d8456u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT16, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_uint16_bigEndian_ex_nums_ERD = {
@@ -215,9 +297,14 @@ static const ERD be_uint16_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_uint16", // namedQName.local
         NULL, // namedQName.ns
+        "be_uint16", // namedQName.name
+        9, // namedQName.nameLength
+        0xba0328fau, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT16, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_uint32_bigEndian_ex_nums_ERD = {
@@ -225,9 +312,14 @@ static const ERD be_uint32_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_uint32", // namedQName.local
         NULL, // namedQName.ns
+        "be_uint32", // namedQName.name
+        9, // namedQName.nameLength
+        0x3e0875f4u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_uint64_bigEndian_ex_nums_ERD = {
@@ -235,9 +327,14 @@ static const ERD be_uint64_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_uint64", // namedQName.local
         NULL, // namedQName.ns
+        "be_uint64", // namedQName.name
+        9, // namedQName.nameLength
+        0xba14721bu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT64, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_uint8_bigEndian_ex_nums_ERD = {
@@ -245,9 +342,14 @@ static const ERD be_uint8_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_uint8", // namedQName.local
         NULL, // namedQName.ns
+        "be_uint8", // namedQName.name
+        8, // namedQName.nameLength
+        0x2a242c63u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT8, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD be_nonNegativeInteger32_bigEndian_ex_nums_ERD = {
@@ -255,9 +357,14 @@ static const ERD be_nonNegativeInteger32_bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "be_nonNegativeInteger32", // namedQName.local
         NULL, // namedQName.ns
+        "be_nonNegativeInteger32", // namedQName.name
+        23, // namedQName.nameLength
+        0x1addd4b6u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const bigEndian bigEndian_compute_offsets;
@@ -305,14 +412,20 @@ static const ERD bigEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "bigEndian", // namedQName.local
         NULL, // namedQName.ns
+        "bigEndian", // namedQName.name
+        9, // namedQName.nameLength
+        0x44d2dd16u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     16, // numChildren
     bigEndian_offsets, // offsets
     bigEndian_childrenERDs, // childrenERDs
     (ERDInitSelf)&bigEndian_initSelf, // initSelf
     (ERDParseSelf)&bigEndian_parseSelf, // parseSelf
     (ERDUnparseSelf)&bigEndian_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&bigEndian_walkSelf, // walkSelf
     NULL // initChoice
 };
 
@@ -321,9 +434,14 @@ static const ERD le_bool16_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_bool16", // namedQName.local
         NULL, // namedQName.ns
+        "le_bool16", // namedQName.name
+        9, // namedQName.nameLength
+        0x40f01848u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_bool32_littleEndian_ex_nums_ERD = {
@@ -331,9 +449,14 @@ static const ERD le_bool32_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_bool32", // namedQName.local
         NULL, // namedQName.ns
+        "le_bool32", // namedQName.name
+        9, // namedQName.nameLength
+        0x3ceb94ceu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_bool8_littleEndian_ex_nums_ERD = {
@@ -341,9 +464,14 @@ static const ERD le_bool8_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_bool8", // namedQName.local
         NULL, // namedQName.ns
+        "le_bool8", // namedQName.name
+        8, // namedQName.nameLength
+        0xc4b1c8a9u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_boolean_littleEndian_ex_nums_ERD = {
@@ -351,9 +479,14 @@ static const ERD le_boolean_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_boolean", // namedQName.local
         NULL, // namedQName.ns
+        "le_boolean", // namedQName.name
+        10, // namedQName.nameLength
+        0x2e9f64cdu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_double_littleEndian_ex_nums_ERD = {
@@ -361,9 +494,14 @@ static const ERD le_double_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_double", // namedQName.local
         NULL, // namedQName.ns
+        "le_double", // namedQName.name
+        9, // namedQName.nameLength
+        0xcfa91222u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_DOUBLE, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_float_littleEndian_ex_nums_ERD = {
@@ -371,9 +509,14 @@ static const ERD le_float_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_float", // namedQName.local
         NULL, // namedQName.ns
+        "le_float", // namedQName.name
+        8, // namedQName.nameLength
+        0xcdda7b1bu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_FLOAT, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_int16_littleEndian_ex_nums_ERD = {
@@ -381,9 +524,14 @@ static const ERD le_int16_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_int16", // namedQName.local
         NULL, // namedQName.ns
+        "le_int16", // namedQName.name
+        8, // namedQName.nameLength
+        0x40b6276fu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT16, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_int32_littleEndian_ex_nums_ERD = {
@@ -391,9 +539,14 @@ static const ERD le_int32_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_int32", // namedQName.local
         NULL, // namedQName.ns
+        "le_int32", // namedQName.name
+        8, // namedQName.nameLength
+        0x4cbab781u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_int64_littleEndian_ex_nums_ERD = {
@@ -401,9 +554,14 @@ static const ERD le_int64_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_int64", // namedQName.local
         NULL, // namedQName.ns
+        "le_int64", // namedQName.name
+        8, // namedQName.nameLength
+        0xc0c229e2u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT64, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_int8_littleEndian_ex_nums_ERD = {
@@ -411,9 +569,14 @@ static const ERD le_int8_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_int8", // namedQName.local
         NULL, // namedQName.ns
+        "le_int8", // namedQName.name
+        7, // namedQName.nameLength
+        0x9a676708u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT8, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_integer64_littleEndian_ex_nums_ERD = {
@@ -421,9 +584,14 @@ static const ERD le_integer64_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_integer64", // namedQName.local
         NULL, // namedQName.ns
+        "le_integer64", // namedQName.name
+        12, // namedQName.nameLength
+        0xd44f642du, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT64, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_uint16_littleEndian_ex_nums_ERD = {
@@ -431,9 +599,14 @@ static const ERD le_uint16_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_uint16", // namedQName.local
         NULL, // namedQName.ns
+        "le_uint16", // namedQName.name
+        9, // namedQName.nameLength
+        0xd10dc7d4u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT16, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_uint32_littleEndian_ex_nums_ERD = {
@@ -441,9 +614,14 @@ static const ERD le_uint32_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_uint32", // namedQName.local
         NULL, // namedQName.ns
+        "le_uint32", // namedQName.name
+        9, // namedQName.nameLength
+        0xc50937c2u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_uint64_littleEndian_ex_nums_ERD = {
@@ -451,9 +629,14 @@ static const ERD le_uint64_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_uint64", // namedQName.local
         NULL, // namedQName.ns
+        "le_uint64", // namedQName.name
+        9, // namedQName.nameLength
+        0x5501cbadu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT64, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_uint8_littleEndian_ex_nums_ERD = {
@@ -461,9 +644,14 @@ static const ERD le_uint8_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_uint8", // namedQName.local
         NULL, // namedQName.ns
+        "le_uint8", // namedQName.name
+        8, // namedQName.nameLength
+        0xde9c4265u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT8, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD le_nonNegativeInteger8_littleEndian_ex_nums_ERD = {
@@ -471,9 +659,14 @@ static const ERD le_nonNegativeInteger8_littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "le_nonNegativeInteger8", // namedQName.local
         NULL, // namedQName.ns
+        "le_nonNegativeInteger8", // namedQName.name
+        22, // namedQName.nameLength
+        0x35e862fbu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_UINT8, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const littleEndian littleEndian_compute_offsets;
@@ -521,14 +714,20 @@ static const ERD littleEndian_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "littleEndian", // namedQName.local
         NULL, // namedQName.ns
+        "littleEndian", // namedQName.name
+        12, // namedQName.nameLength
+        0x98ccb08eu, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     16, // numChildren
     littleEndian_offsets, // offsets
     littleEndian_childrenERDs, // childrenERDs
     (ERDInitSelf)&littleEndian_initSelf, // initSelf
     (ERDParseSelf)&littleEndian_parseSelf, // parseSelf
     (ERDUnparseSelf)&littleEndian_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&littleEndian_walkSelf, // walkSelf
     NULL // initChoice
 };
 
@@ -537,9 +736,14 @@ static const ERD boolean_false_fixed_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "boolean_false", // namedQName.local
         NULL, // namedQName.ns
+        "boolean_false", // namedQName.name
+        13, // namedQName.nameLength
+        0xd19dc033u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD boolean_true_fixed_ex_nums_ERD = {
@@ -547,9 +751,14 @@ static const ERD boolean_true_fixed_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "boolean_true", // namedQName.local
         NULL, // namedQName.ns
+        "boolean_true", // namedQName.name
+        12, // namedQName.nameLength
+        0x362ae758u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_BOOLEAN, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD float_1_5_fixed_ex_nums_ERD = {
@@ -557,9 +766,14 @@ static const ERD float_1_5_fixed_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "float_1_5", // namedQName.local
         NULL, // namedQName.ns
+        "float_1_5", // namedQName.name
+        9, // namedQName.nameLength
+        0x42843e59u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_FLOAT, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const ERD int_32_fixed_ex_nums_ERD = {
@@ -567,9 +781,14 @@ static const ERD int_32_fixed_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "int_32", // namedQName.local
         NULL, // namedQName.ns
+        "int_32", // namedQName.name
+        6, // namedQName.nameLength
+        0x8188be96u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     PRIMITIVE_INT32, // typeCode
-    0, NULL, NULL, NULL, NULL, NULL, NULL
+    false, // isArray
+    0, NULL, NULL, NULL, NULL, NULL, NULL, NULL
 };
 
 static const fixed fixed_compute_offsets;
@@ -593,14 +812,20 @@ static const ERD fixed_ex_nums_ERD = {
         NULL, // namedQName.prefix
         "fixed", // namedQName.local
         NULL, // namedQName.ns
+        "fixed", // namedQName.name
+        5, // namedQName.nameLength
+        0xb3f55bf9u, // namedQName.nameHash
+        NULL, // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     4, // numChildren
     fixed_offsets, // offsets
     fixed_childrenERDs, // childrenERDs
     (ERDInitSelf)&fixed_initSelf, // initSelf
     (ERDParseSelf)&fixed_parseSelf, // parseSelf
     (ERDUnparseSelf)&fixed_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&fixed_walkSelf, // walkSelf
     NULL // initChoice
 };
 
@@ -625,33 +850,43 @@ static const ERD ex_nums_ERD = {
         NULL, // namedQName.prefix
         "ex_nums", // namedQName.local
         "http://example.com", // namedQName.ns
+        "ex_nums", // namedQName.name
+        7, // namedQName.nameLength
+        0xb7118a70u, // namedQName.nameHash
+        "xmlns", // namedQName.xmlns
     },
     COMPLEX, // typeCode
+    false, // isArray
     4, // numChildren
     ex_nums_offsets, // offsets
     ex_nums_childrenERDs, // childrenERDs
     (ERDInitSelf)&ex_nums_initSelf, // initSelf
     (ERDParseSelf)&ex_nums_parseSelf, // parseSelf
     (ERDUnparseSelf)&ex_nums_unparseSelf, // unparseSelf
+    (ERDWalkSelf)&ex_nums_walkSelf, // walkSelf
     NULL // initChoice
 };
 
-// Return a root element for parsing or unparsing the infoset
+// Return a new root element for parsing or unparsing the infoset
+// (caller owns it and must free it)
 
 InfosetBase *
 rootElement(void)
 {
-    static bool initialized;
-    static ex_nums root;
-    if (!initialized)
+    ex_nums *root = malloc(sizeof(ex_nums));
+    if (root)
     {
-        ex_nums_initSelf(&root);
-        initialized = true;
+        ex_nums_initSelf(root);
+        return &root->_base;
     }
-    return &root._base;
+    return NULL;
 }
 
-// Initialize, parse, and unparse nodes of the infoset
+// Tell callers whether every root element parses the same number of bytes
+
+const bool rootElementFixedLength = true;
+
+// Initialize, parse, unparse, and walk nodes of the infoset
 
 static void
 array_initSelf(array *instance)
@@ -709,6 +944,21 @@ array_unparseSelf(const array *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+array_walkSelf(const array *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    UNUSED(context);
+    error = walkNumberRun(handler, &array_childrenERDs[0], &instance->be_bool16[0], 2);
+    if (error) return error;
+    error = walkNumberRun(handler, &array_childrenERDs[2], &instance->be_float[0], 3);
+    if (error) return error;
+    error = walkNumberRun(handler, &array_childrenERDs[5], &instance->be_int16[0], 3);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
 static void
 bigEndian_initSelf(bigEndian *instance)
 {
@@ -805,6 +1055,42 @@ bigEndian_unparseSelf(const bigEndian *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+bigEndian_walkSelf(const bigEndian *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    UNUSED(context);
+    error = walkNumberRun(handler, &bigEndian_childrenERDs[0], &instance->be_bool16, 4);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_double_bigEndian_ex_nums_ERD, &instance->be_double);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_float_bigEndian_ex_nums_ERD, &instance->be_float);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_int16_bigEndian_ex_nums_ERD, &instance->be_int16);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_int32_bigEndian_ex_nums_ERD, &instance->be_int32);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_int64_bigEndian_ex_nums_ERD, &instance->be_int64);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_int8_bigEndian_ex_nums_ERD, &instance->be_int8);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_integer16_bigEndian_ex_nums_ERD, &instance->be_integer16);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_uint16_bigEndian_ex_nums_ERD, &instance->be_uint16);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_uint32_bigEndian_ex_nums_ERD, &instance->be_uint32);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_uint64_bigEndian_ex_nums_ERD, &instance->be_uint64);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_uint8_bigEndian_ex_nums_ERD, &instance->be_uint8);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &be_nonNegativeInteger32_bigEndian_ex_nums_ERD,
+                                     &instance->be_nonNegativeInteger32);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
 static void
 littleEndian_initSelf(littleEndian *instance)
 {
@@ -901,6 +1187,40 @@ littleEndian_unparseSelf(const littleEndian *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+littleEndian_walkSelf(const littleEndian *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    UNUSED(context);
+    error = walkNumberRun(handler, &littleEndian_childrenERDs[0], &instance->le_bool16, 4);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_double_littleEndian_ex_nums_ERD, &instance->le_double);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_float_littleEndian_ex_nums_ERD, &instance->le_float);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_int16_littleEndian_ex_nums_ERD, &instance->le_int16);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_int32_littleEndian_ex_nums_ERD, &instance->le_int32);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_int64_littleEndian_ex_nums_ERD, &instance->le_int64);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_int8_littleEndian_ex_nums_ERD, &instance->le_int8);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_integer64_littleEndian_ex_nums_ERD,
+                                     &instance->le_integer64);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_uint16_littleEndian_ex_nums_ERD, &instance->le_uint16);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_uint32_littleEndian_ex_nums_ERD, &instance->le_uint32);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &le_uint64_littleEndian_ex_nums_ERD, &instance->le_uint64);
+    if (error) return error;
+    error = walkNumberRun(handler, &littleEndian_childrenERDs[14], &instance->le_uint8, 2);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
 static void
 fixed_initSelf(fixed *instance)
 {
@@ -953,6 +1273,21 @@ fixed_unparseSelf(const fixed *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+fixed_walkSelf(const fixed *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    UNUSED(context);
+    error = walkNumberRun(handler, &fixed_childrenERDs[0], &instance->boolean_false, 2);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &float_1_5_fixed_ex_nums_ERD, &instance->float_1_5);
+    if (error) return error;
+    error = handler->visitNumberElem(handler, &int_32_fixed_ex_nums_ERD, &instance->int_32);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
 static void
 ex_nums_initSelf(ex_nums *instance)
 {
@@ -989,3 +1324,19 @@ ex_nums_unparseSelf(const ex_nums *instance, UState *ustate)
     if (ustate->error) return;
 }
 
+static const Error *
+ex_nums_walkSelf(const ex_nums *instance, const VisitEventHandler *handler, RuntimeContext *context)
+{
+    const Error *error = handler->visitStartComplex(handler, &instance->_base);
+    if (error) return error;
+    error = array_walkSelf(&instance->array, handler, context);
+    if (error) return error;
+    error = bigEndian_walkSelf(&instance->bigEndian, handler, context);
+    if (error) return error;
+    error = littleEndian_walkSelf(&instance->littleEndian, handler, context);
+    if (error) return error;
+    error = fixed_walkSelf(&instance->fixed, handler, context);
+    if (error) return error;
+    return handler->visitEndComplex(handler, &instance->_base);
+}
+
@@ -19,8 +19,11 @@ package org.apache.daffodil.runtime2
 
 import java.io.ByteArrayInputStream
 import java.io.ByteArrayOutputStream
+import java.nio.ByteBuffer
 import java.nio.channels.Channels
+import java.nio.charset.StandardCharsets
 import org.apache.daffodil.Implicits.intercept
+import org.apache.daffodil.api.Runtime2BuildProfile
 import org.apache.daffodil.compiler.Compiler
 import org.apache.daffodil.util.Misc
 import org.apache.daffodil.util.SchemaUtils
@@ -103,6 +106,144 @@ class TestCodeGenerator {
     assert(os.exists(executable))
   }
 
+  @Test def test_compileCode_profiles(): Unit = {
+    // Generate code from the test schema once for each build profile
+    val pf = Compiler().compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val profiles = Seq(Runtime2BuildProfile.Debug, Runtime2BuildProfile.Release, Runtime2BuildProfile.Native)
+    for (profile <- profiles) {
+      // Compile the generated code with the profile successfully and
+      // without any compiler output (falling back from link-time
+      // optimization is only a warning)
+      val codeDir = cg.generateCode(None, (tempDir/profile.toString).toString)
+      val executable = cg.compileCode(codeDir, profile)
+      val messages = cg.getDiagnostics.map(_.getMessage()).mkString("\n")
+      assert(!cg.isError, messages)
+      assert(!messages.contains("Unexpected compiler output"), messages)
+      assert(os.exists(executable))
+
+      // Check that the executable parses correctly
+      val dp = new Runtime2DataProcessor(executable)
+      try {
+        val pr = dp.parse(new ByteArrayInputStream(Misc.hex2Bytes("00000005")))
+        assert(!pr.isError, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+        TestUtils.assertEqualsXMLElements(<e1><x>5</x></e1>, pr.infosetAsXML)
+      } finally {
+        dp.close()
+      }
+    }
+  }
+
+  @Test def test_compileCode_cache(): Unit = {
+    // Compile the test schema with a compile cache under tempDir
+    val compiler = Compiler().withTunable("tempFilePath", tempDir.toString)
+    val pf = compiler.compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val executable = cg.compileCode(cg.generateCode(None, (tempDir/"first").toString))
+    assert(!cg.isError, cg.getDiagnostics.map(_.getMessage()).mkString("\n"))
+    assert(os.exists(executable))
+
+    // The first build misses the cache and fills it with one executable and
+    // objects for the source files which don't include the generated code
+    val cacheDir = tempDir/"daffodil-runtime2-cache"
+    assert(os.list(cacheDir/"outputs").size == 1)
+    val objects = os.list(cacheDir/"objects")
+    assert(objects.nonEmpty)
+
+    // Building the same code again hits the cache and adds nothing to it
+    val executable2 = cg.compileCode(cg.generateCode(None, (tempDir/"second").toString))
+    assert(!cg.isError, cg.getDiagnostics.map(_.getMessage()).mkString("\n"))
+    assertArrayEquals(os.read.bytes(executable), os.read.bytes(executable2))
+    assert(os.list(cacheDir/"outputs").size == 1)
+    assert(os.list(cacheDir/"objects") == objects)
+
+    // Building another schema's code misses the cached executable but
+    // reuses every cached object
+    val otherSchema = SchemaUtils.dfdlTestSchema(
+      <xs:include schemaLocation="org/apache/daffodil/xsd/DFDLGeneralFormat.dfdl.xsd"/>,
+      <dfdl:format representation="binary" ref="GeneralFormat"/>,
+      <xs:element name="e2">
+        <xs:complexType>
+          <xs:sequence>
+            <xs:element name="y" type="xs:short"/>
+          </xs:sequence>
+        </xs:complexType>
+      </xs:element>)
+    val pf2 = compiler.compileNode(otherSchema)
+    val cg2 = pf2.forLanguage("c")
+    val executable3 = cg2.compileCode(cg2.generateCode(None, (tempDir/"third").toString))
+    assert(!cg2.isError, cg2.getDiagnostics.map(_.getMessage()).mkString("\n"))
+    assert(os.exists(executable3))
+    assert(os.list(cacheDir/"outputs").size == 2)
+    assert(os.list(cacheDir/"objects") == objects)
+
+    // Editing a header which every source file includes misses every cached
+    // object and the cached executable, so everything gets compiled again
+    val editedDir = tempDir/"edited"
+    os.copy(tempDir/"first", editedDir)
+    os.write.append(editedDir/"c"/"libruntime"/"errors.h", "\n// edited to change the cache keys\n")
+    val executable4 = cg.compileCode(editedDir/"c")
+    assert(!cg.isError, cg.getDiagnostics.map(_.getMessage()).mkString("\n"))
+    assert(os.list(cacheDir/"outputs").size == 3)
+    assert(os.list(cacheDir/"objects").size == 2 * objects.size)
+
+    // Check that the rebuilt executable parses correctly
+    val dp = new Runtime2DataProcessor(executable4)
+    try {
+      val pr = dp.parse(new ByteArrayInputStream(Misc.hex2Bytes("00000005")))
+      assert(!pr.isError, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+      TestUtils.assertEqualsXMLElements(<e1><x>5</x></e1>, pr.infosetAsXML)
+    } finally {
+      dp.close()
+    }
+  }
+
+  @Test def test_compileTrainedCode_success(): Unit = {
+    // Generate code from the test schema and write a training input
+    val pf = Compiler().compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val codeDir = cg.generateCode(None, tempDir.toString)
+    val trainingInput = tempDir/"training.dat"
+    os.write(trainingInput, Misc.hex2Bytes("00000005"))
+
+    // Build the executable with profile-guided optimization successfully
+    // and without any compiler output from any stage
+    val executable = cg.compileTrainedCode(codeDir, Runtime2BuildProfile.Release, Seq(trainingInput))
+    val messages = cg.getDiagnostics.map(_.getMessage()).mkString("\n")
+    assert(!cg.isError, messages)
+    assert(!messages.contains("Unexpected compiler output"), messages)
+    assert(os.exists(executable))
+    assert(os.list(codeDir/"pgo").nonEmpty)
+
+    // Check that the trained executable still parses correctly
+    val dp = new Runtime2DataProcessor(executable)
+    try {
+      val pr = dp.parse(new ByteArrayInputStream(Misc.hex2Bytes("00000005")))
+      assert(!pr.isError, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+      TestUtils.assertEqualsXMLElements(<e1><x>5</x></e1>, pr.infosetAsXML)
+    } finally {
+      dp.close()
+    }
+  }
+
+  @Test def test_compileTrainedCode_failedTraining(): Unit = {
+    // Generate code from the test schema and write a training input which
+    // is too short to parse
+    val pf = Compiler().compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val codeDir = cg.generateCode(None, tempDir.toString)
+    val trainingInput = tempDir/"training.dat"
+    os.write(trainingInput, Misc.hex2Bytes("0000"))
+
+    // Build the executable anyway, warning only about the failed training run
+    val executable = cg.compileTrainedCode(codeDir, Runtime2BuildProfile.Release, Seq(trainingInput))
+    val messages = cg.getDiagnostics.map(_.getMessage()).mkString("\n")
+    assert(!cg.isError, messages)
+    assert(os.exists(executable))
+    assert(messages.contains("Training run failed"), messages)
+    assert(!messages.contains("Unexpected compiler output"), messages)
+  }
+
   @Test def test_parse_success(): Unit = {
     // Compile the test schema into a C executable
     val pf = Compiler().compileNode(testSchema)
@@ -112,12 +253,16 @@ class TestCodeGenerator {
 
     // Create a Runtime2DataProcessor and parse a binary int32 number successfully
     val dp = new Runtime2DataProcessor(executable)
-    val b = Misc.hex2Bytes("00000005")
-    val input = new ByteArrayInputStream(b)
-    val pr = dp.parse(input)
-    assert(!pr.isError && pf.getDiagnostics.isEmpty, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
-    val expected = <e1><x>5</x></e1>
-    TestUtils.assertEqualsXMLElements(expected, pr.infosetAsXML)
+    try {
+      val b = Misc.hex2Bytes("00000005")
+      val input = new ByteArrayInputStream(b)
+      val pr = dp.parse(input)
+      assert(!pr.isError && pf.getDiagnostics.isEmpty, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+      val expected = <e1><x>5</x></e1>
+      TestUtils.assertEqualsXMLElements(expected, pr.infosetAsXML)
+    } finally {
+      dp.close()
+    }
   }
 
   @Test def test_unparse_success(): Unit = {
@@ -129,11 +274,142 @@ class TestCodeGenerator {
 
     // Create a Runtime2DataProcessor and unparse a binary int32 number successfully
     val dp = new Runtime2DataProcessor(executable)
-    val input = Channels.newInputStream(Misc.stringToReadableByteChannel("<e1><x>5</x></e1>"))
-    val output = new ByteArrayOutputStream()
-    val pr = dp.unparse(input, output)
-    assert(!pr.isError && pf.getDiagnostics.isEmpty, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
-    val expected = Misc.hex2Bytes("00000005")
-    assertArrayEquals(expected, output.toByteArray)
+    try {
+      val input = Channels.newInputStream(Misc.stringToReadableByteChannel("<e1><x>5</x></e1>"))
+      val output = new ByteArrayOutputStream()
+      val pr = dp.unparse(input, output)
+      assert(!pr.isError && pf.getDiagnostics.isEmpty, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+      val expected = Misc.hex2Bytes("00000005")
+      assertArrayEquals(expected, output.toByteArray)
+    } finally {
+      dp.close()
+    }
+  }
+
+  @Test def test_worker_reuse(): Unit = {
+    // Compile the test schema into a C executable
+    val pf = Compiler().compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val codeDir = cg.generateCode(None, tempDir.toString)
+    val executable = cg.compileCode(codeDir)
+
+    // Parse and unparse several times, checking that every call after the
+    // first reuses the one worker the first call started
+    val dp = new Runtime2DataProcessor(executable)
+    try {
+      for (i <- 1 to 3) {
+        val pr = dp.parse(new ByteArrayInputStream(Misc.hex2Bytes(f"$i%08x")))
+        assert(!pr.isError, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+        TestUtils.assertEqualsXMLElements(<e1><x>{i.toString}</x></e1>, pr.infosetAsXML)
+        assert(dp.idleWorkerCount == 1)
+
+        val input = Channels.newInputStream(Misc.stringToReadableByteChannel(s"<e1><x>$i</x></e1>"))
+        val output = new ByteArrayOutputStream()
+        val upr = dp.unparse(input, output)
+        assert(!upr.isError, upr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+        assertArrayEquals(Misc.hex2Bytes(f"$i%08x"), output.toByteArray)
+        assert(dp.idleWorkerCount == 1)
+      }
+    } finally {
+      dp.close()
+    }
+    assert(dp.idleWorkerCount == 0)
+  }
+
+  @Test def test_library_success(): Unit = {
+    // Compile the test schema into a C executable and shared library
+    val pf = Compiler().compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val codeDir = cg.generateCode(None, tempDir.toString)
+    val executable = cg.compileCode(codeDir)
+    val library = cg.compileLibrary(codeDir)
+    assert(!cg.isError, cg.getDiagnostics.map(_.getMessage()).mkString("\n"))
+    assert(os.exists(library))
+
+    // Parse and unparse a binary int32 number in-process successfully
+    val dp = new Runtime2DataProcessor(executable, Some(library))
+    try {
+      val pr = dp.parse(new ByteArrayInputStream(Misc.hex2Bytes("00000005")))
+      assert(!pr.isError, pr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+      TestUtils.assertEqualsXMLElements(<e1><x>5</x></e1>, pr.infosetAsXML)
+
+      val input = Channels.newInputStream(Misc.stringToReadableByteChannel("<e1><x>5</x></e1>"))
+      val output = new ByteArrayOutputStream()
+      val upr = dp.unparse(input, output)
+      assert(!upr.isError, upr.getDiagnostics.map(_.getMessage()).mkString("\n"))
+      assertArrayEquals(Misc.hex2Bytes("00000005"), output.toByteArray)
+    } finally {
+      dp.close()
+    }
+  }
+
+  @Test def test_library_buffers(): Unit = {
+    // Compile the test schema into a C shared library
+    val pf = Compiler().compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val codeDir = cg.generateCode(None, tempDir.toString)
+    val library = cg.compileLibrary(codeDir)
+    assert(!cg.isError, cg.getDiagnostics.map(_.getMessage()).mkString("\n"))
+
+    // Load the shared library and call its parse and unparse directly
+    val lib = new Runtime2Library(library)
+    try {
+      val data = Misc.hex2Bytes("00000005")
+      val input = ByteBuffer.allocateDirect(1024)
+      val output = ByteBuffer.allocateDirect(1024)
+      val messages = ByteBuffer.allocateDirect(1024)
+      val lengths = new Array[Long](2)
+
+      // Parse a binary int32 number into an XML infoset
+      input.put(data)
+      assert(lib.parse("xml", input, data.length, output, messages, lengths) == Runtime2Library.Ok)
+      assert(lengths(1) == 0)
+      val infoset = new Array[Byte](lengths(0).toInt)
+      output.get(infoset)
+      val infosetXML = scala.xml.XML.loadString(new String(infoset, StandardCharsets.UTF_8))
+      TestUtils.assertEqualsXMLElements(<e1><x>5</x></e1>, infosetXML)
+
+      // Unparse that infoset back into the same number
+      input.clear()
+      input.put(infoset)
+      output.clear()
+      assert(lib.unparse("xml", input, infoset.length, output, messages, lengths) == Runtime2Library.Ok)
+      assert(lengths(1) == 0)
+      val unparsed = new Array[Byte](lengths(0).toInt)
+      output.get(unparsed)
+      assertArrayEquals(data, unparsed)
+
+      // Parse into a too small buffer and check we're told how big a buffer we need
+      input.clear()
+      input.put(data)
+      val tiny = ByteBuffer.allocateDirect(1)
+      assert(lib.parse("xml", input, data.length, tiny, messages, lengths) == Runtime2Library.Full)
+      assert(lengths(0) == infoset.length)
+    } finally {
+      lib.close()
+    }
+  }
+
+  @Test def test_library_malformedXML(): Unit = {
+    // Compile the test schema into a C executable and shared library
+    val pf = Compiler().compileNode(testSchema)
+    val cg = pf.forLanguage("c")
+    val codeDir = cg.generateCode(None, tempDir.toString)
+    val executable = cg.compileCode(codeDir)
+    val library = cg.compileLibrary(codeDir)
+    assert(!cg.isError, cg.getDiagnostics.map(_.getMessage()).mkString("\n"))
+
+    // Unparse a malformed number and check the error quotes it intact
+    // (the reader holding the number is gone by the time it's reported)
+    val dp = new Runtime2DataProcessor(executable, Some(library))
+    try {
+      val input = Channels.newInputStream(Misc.stringToReadableByteChannel("<e1><x>5x</x></e1>"))
+      val upr = dp.unparse(input, new ByteArrayOutputStream())
+      assert(upr.isError)
+      val messages = upr.getDiagnostics.map(_.getMessage()).mkString("\n")
+      assert(messages.contains("infoset data '5x'"), messages)
+    } finally {
+      dp.close()
+    }
   }
 }
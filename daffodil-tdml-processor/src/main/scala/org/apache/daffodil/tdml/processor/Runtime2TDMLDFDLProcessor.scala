@@ -18,6 +18,7 @@
 package org.apache.daffodil.tdml.processor
 
 import java.io.ByteArrayInputStream
+import java.io.IOException
 
 import org.apache.daffodil.api._
 import org.apache.daffodil.compiler.Compiler
@@ -115,13 +116,23 @@ final class Runtime2TDMLDFDLProcessorFactory private(
       // Compile the generated code into an executable
       val executable = generator.compileCode(codeDir)
 
+      // Also try to compile the generated code into a shared library which
+      // the processor can call in-process, using another CodeGenerator so a
+      // failure (e.g., no JNI headers) only makes the processor fall back
+      // to running the executable
+      val libraryGenerator = pf.forLanguage("c")
+      val library = if (generator.isError) None else {
+        val lib = libraryGenerator.compileLibrary(codeDir)
+        if (libraryGenerator.isError) None else Some(lib)
+      }
+
       // Summarize the result of compiling the schema for the test
       val compileResult = if (generator.isError) {
         Left(generator.getDiagnostics) // C code compilation diagnostics
       } else {
         // Create a processor for running the test using the executable, passing it
         // generator.diagnostics in order to let us check generator warnings later
-        val processor = new Runtime2TDMLDFDLProcessor(tempDir, executable, generator.getDiagnostics)
+        val processor = new Runtime2TDMLDFDLProcessor(tempDir, executable, library, generator.getDiagnostics)
         // Sadly, TDMLRunner never checks generator diagnostics in "Right" tuple below
         // nor does it check processor diagnostics in cross tests (runtime2's TDML tests)
         // unless you set defaultShouldDoWarningComparisonOnCrossTests true in RunnerFactory
@@ -139,13 +150,18 @@ final class Runtime2TDMLDFDLProcessorFactory private(
  * The responsibility of this class is just for TDML matching up. That is dealing with
  * TDML XML Infosets, feeding to the unparser, creating XML from the result created by
  * the Runtime2DataProcessor. All the "real work" is done by Runtime2DataProcessor.
+ * Calls the shared library in-process if given one which loads, else runs the
+ * executable in worker subprocesses.
  */
-class Runtime2TDMLDFDLProcessor(tempDir: os.Path, executable: os.Path,
+class Runtime2TDMLDFDLProcessor(tempDir: os.Path, executable: os.Path, library: Option[os.Path],
                                 var diagnostics: Seq[Diagnostic]) extends TDMLDFDLProcessor {
 
   override type R = Runtime2TDMLDFDLProcessor
 
-  private val dataProcessor = new Runtime2DataProcessor(executable)
+  private val dataProcessor = library.flatMap { lib =>
+    try Some(new Runtime2DataProcessor(executable, Some(lib)))
+    catch { case _: IOException | _: UnsatisfiedLinkError => None }
+  }.getOrElse(new Runtime2DataProcessor(executable))
   private var anyErrors: Boolean = false
 
   @deprecated("Use withDebugging.", "2.6.0")
@@ -174,9 +190,9 @@ class Runtime2TDMLDFDLProcessor(tempDir: os.Path, executable: os.Path,
 
   // Run the C code, collect and save the infoset with any errors and
   // diagnostics, and return a [[TDMLParseResult]] summarizing the result.
-  // The C code will run in a subprocess, parse the input stream, write
-  // an XML infoset on its standard output, and write any error messages
-  // on its standard output (all done in [[Runtime2DataProcessor.parse]]).
+  // The C code will run in-process or in a long-lived worker subprocess,
+  // parse the input stream, and reply with an XML infoset and any error
+  // messages (all done in [[Runtime2DataProcessor.parse]]).
   override def parse(is: java.io.InputStream, lengthLimitInBits: Long): TDMLParseResult = {
     // TODO: pass lengthLimitInBits to the C program to tell it how big the data is
     val pr = dataProcessor.parse(is)
@@ -187,9 +203,9 @@ class Runtime2TDMLDFDLProcessor(tempDir: os.Path, executable: os.Path,
 
   // Run the C code, collect and save the unparsed data with any errors and
   // diagnostics, and return a [[TDMLUnparseResult]] summarizing the result.
-  // The C code will run in a subprocess, unparse the input stream, write
-  // the unparsed data on its standard output, and write any error messages
-  // on its standard output (all done in [[Runtime2DataProcessor.unparse]]).
+  // The C code will run in-process or in a long-lived worker subprocess,
+  // unparse the input stream, and reply with the unparsed data and any
+  // error messages (all done in [[Runtime2DataProcessor.unparse]]).
   override def unparse(infosetXML: scala.xml.Node, outStream: java.io.OutputStream): TDMLUnparseResult = {
     val inStream = new ByteArrayInputStream(infosetXML.toString.getBytes())
     val upr = dataProcessor.unparse(inStream, outStream)
@@ -203,9 +219,13 @@ class Runtime2TDMLDFDLProcessor(tempDir: os.Path, executable: os.Path,
   }
 
   /**
-   * Remove the generated executable
+   * Stop the executable's workers, close the shared library, and remove
+   * the generated executable and shared library
    */
-  override def cleanUp(): Unit = os.remove.all(tempDir)
+  override def cleanUp(): Unit = {
+    dataProcessor.close()
+    os.remove.all(tempDir)
+  }
 }
 
 final class Runtime2TDMLParseResult(pr: ParseResult) extends TDMLParseResult {
@@ -36,4 +36,7 @@ class TestExNums {
   @Test def test_ex_nums_parse_runtime2(): Unit = { runner.runOneTest("ex_nums_parse_runtime2") }
   @Test def test_ex_nums_unparse_runtime2(): Unit = { runner.runOneTest("ex_nums_unparse_runtime2") }
   @Test def test_ex_nums_unparse_errors(): Unit = { runner.runOneTest("ex_nums_unparse_errors") }
+  @Test def test_ex_nums_unparse_edges(): Unit = { runner.runOneTest("ex_nums_unparse_edges") }
+  @Test def test_ex_nums_unparse_negative(): Unit = { runner.runOneTest("ex_nums_unparse_negative") }
+  @Test def test_ex_nums_unparse_underflow(): Unit = { runner.runOneTest("ex_nums_unparse_underflow") }
 }